@@ -203,7 +203,7 @@ void setup() {
   SetupLmicKey<appEui, devEui, appKey>::setup(LMIC);
 
   // set clock error to allow good connection.
-  LMIC.setClockError(MAX_CLOCK_ERROR * 2 / 100);
+  LMIC.setClockError(MAX_CLOCK_ERROR * 1 / 100);
   // LMIC.setAntennaPowerAdjustment(-14);
 
   // Only work with special boot loader.
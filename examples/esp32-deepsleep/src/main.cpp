@@ -10,6 +10,7 @@
 #include "lorakeys.h"
 
 void do_send();
+void start_lmic();
 
 // Schedule TX every this many seconds (might become longer due to duty
 // cycle limitations).
@@ -76,6 +77,10 @@ void onEvent(EventType ev) {
   case EventType::LINK_ALIVE:
     PRINT_DEBUG(2, F("EV_LINK_ALIVE"));
     break;
+  case EventType::READY:
+    PRINT_DEBUG(2, F("EV_READY"));
+    start_lmic();
+    break;
   default:
     PRINT_DEBUG(2, F("Unknown event"));
     break;
@@ -106,12 +111,16 @@ void setup() {
   }
 
   SPI.begin();
-  // LMIC init
+  // LMIC init, radio reset runs in background (READY event at the end).
   os_init();
-  LMIC.init();
+  LMIC.setEventCallBack(onEvent);
+  LMIC.initAsync();
+  // sensors can be started here.
+}
+
+void start_lmic() {
   // Reset the MAC state. Session and pending data transfers will be discarded.
   LMIC.reset();
-  LMIC.setEventCallBack(onEvent);
   SetupLmicKey<appEui, devEui, appKey>::setup(LMIC);
 
   // set clock error to allow good connection.
@@ -35,8 +35,10 @@ Change to use this project type and adapt to some C++ type.
 
 #ifdef __AVR__
 #include <avr/pgmspace.h>
-#else 
+#elif defined(ARDUINO)
 #include <pgmspace.h>
+#else
+#include "../hal/hal_native.h"
 #endif
 
 namespace {
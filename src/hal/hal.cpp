@@ -8,7 +8,7 @@
  * This the HAL to run LMIC on top of the Arduino environment.
  *******************************************************************************/
 
-#ifndef ARDUINO_ARCH_ESP32
+#if defined(ARDUINO) && !defined(ARDUINO_ARCH_ESP32)
 #include "hal.h"
 #include "print_debug.h"
 #include <Arduino.h>
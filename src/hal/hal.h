@@ -45,6 +45,19 @@ OsTime hal_ticks();
 void hal_add_time_in_sleep(OsDeltaTime nb_tick);
 #endif
 
+#ifdef __AVR__
+/*
+ * measure watchdog period against cpu clock (take ~64ms).
+ */
+void hal_calibrate_wdt();
+
+/*
+ * return real duration of watchdog period (WDTO_xxx value).
+ * calibration is refreshed periodically.
+ */
+OsDeltaTime hal_wdt_period(uint8_t wdto);
+#endif
+
 /*
  * busy-wait until specified timestamp is reached.
  */
@@ -64,4 +77,8 @@ void hal_failed(const char *file, uint16_t line);
 
 void hal_store_trigger();
 
+#ifndef ARDUINO
+#include "hal_native.h"
+#endif
+
 #endif // _hal_hal_h_
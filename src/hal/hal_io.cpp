@@ -1,3 +1,4 @@
+#ifdef ARDUINO
 #include "hal_io.h"
 #include "../lmic/lmic.h"
 #include "hal.h"
@@ -5,10 +6,58 @@
 #include <SPI.h>
 #include <algorithm>
 #include <hal/print_debug.h>
+#ifdef __AVR__
+#include <avr/sleep.h>
+#endif
 
-static const SPISettings settings(10000000, MSBFIRST, SPI_MODE0);
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
 
-HalIo::HalIo(lmic_pinmap const &pins) : lmic_pins(pins) {}
+namespace {
+// one capture slot by radio.
+constexpr uint8_t MAX_EDGE_SLOTS = 2;
+constexpr uint8_t NO_EDGE_SLOT = 0xFF;
+uint8_t used_edge_slots = 0;
+
+// micros() is usable in interrupt on all platform, it is converted to
+// OsTime when read.
+volatile uint32_t edge_us[MAX_EDGE_SLOTS];
+volatile uint8_t edge_captured = 0;
+
+// Keep only the first edge, it is the end of the radio operation.
+template <uint8_t slot> void IRAM_ATTR capture_edge() {
+  if (!(edge_captured & (1 << slot))) {
+    edge_us[slot] = micros();
+    edge_captured |= (1 << slot);
+  }
+}
+
+using edge_isr_t = void (*)();
+edge_isr_t const EDGE_ISR[MAX_EDGE_SLOTS] = {capture_edge<0>, capture_edge<1>};
+
+#ifdef ARDUINO_ARCH_ESP32
+// given on busy falling edge, the task waiting for it is blocked meanwhile
+// (other tasks and the idle task light sleep run).
+SemaphoreHandle_t busy_semaphore = nullptr;
+
+void IRAM_ATTR busy_falling() {
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(busy_semaphore, &woken);
+  if (woken) {
+    portYIELD_FROM_ISR();
+  }
+}
+#else
+// nothing to do, the interrupt only wake up the MCU.
+void IRAM_ATTR busy_falling() {}
+#endif
+} // namespace
+
+HalIo::HalIo(lmic_pinmap const &pins)
+    : lmic_pins(pins),
+      spi_settings(pins.spi_freq ? pins.spi_freq : DEFAULT_SPI_FREQ, MSBFIRST,
+                   SPI_MODE0) {}
 
 void HalIo::write_reg(uint8_t const addr, uint8_t const data) const {
   beginspi();
@@ -29,9 +78,7 @@ void HalIo::write_buffer(uint8_t const addr, uint8_t const *const buf,
                          uint8_t const len) const {
   beginspi();
   spi(addr | 0x80);
-  for (uint8_t i = 0; i < len; i++) {
-    spi(buf[i]);
-  }
+  spi_write(buf, len);
   endspi();
 }
 
@@ -39,23 +86,41 @@ void HalIo::read_buffer(uint8_t const addr, uint8_t *const buf,
                         uint8_t const len) const {
   beginspi();
   spi(addr & 0x7F);
-  std::generate_n(buf, len, [this]() { return spi(0x00); });
+  spi_read(buf, len);
   endspi();
 }
 
 void HalIo::beginspi() const {
-  SPI.beginTransaction(settings);
+  SPI.beginTransaction(spi_settings);
+#ifdef __AVR__
+  // same as digitalWrite without pin lookup
+  uint8_t const sreg = SREG;
+  cli();
+  *nss_port &= ~nss_mask;
+  SREG = sreg;
+#else
   digitalWrite(lmic_pins.nss, 0);
+#endif
 }
 
 void HalIo::endspi() const {
+#ifdef __AVR__
+  uint8_t const sreg = SREG;
+  cli();
+  *nss_port |= nss_mask;
+  SREG = sreg;
+#else
   digitalWrite(lmic_pins.nss, 1);
+#endif
   SPI.endTransaction();
 }
 
 // perform SPI transaction with radio
 uint8_t HalIo::spi(uint8_t const out) const {
   uint8_t res = SPI.transfer(out);
+  if (IS_DEBUG_ENABLE(2)) {
+    spi_count++;
+  }
   /*
       Serial.print(">");
       Serial.print(out, HEX);
@@ -65,6 +130,44 @@ uint8_t HalIo::spi(uint8_t const out) const {
   return res;
 }
 
+void HalIo::spi_write(uint8_t const *const buf, uint8_t const len) const {
+  if (IS_DEBUG_ENABLE(2)) {
+    spi_count += len;
+  }
+#if defined(__AVR__)
+  // keep the next byte ready, SPDR is loaded as soon as transfer is done.
+  for (uint8_t i = 0; i < len; i++) {
+    uint8_t const out = buf[i];
+    if (i > 0) {
+      while (!(SPSR & _BV(SPIF)))
+        ;
+    }
+    SPDR = out;
+  }
+  if (len > 0) {
+    while (!(SPSR & _BV(SPIF)))
+      ;
+    // clear SPIF
+    (void)SPDR;
+  }
+#elif defined(ARDUINO_ARCH_ESP32)
+  SPI.writeBytes(buf, len);
+#else
+  for (uint8_t i = 0; i < len; i++) {
+    SPI.transfer(buf[i]);
+  }
+#endif
+}
+
+void HalIo::spi_read(uint8_t *const buf, uint8_t const len) const {
+  if (IS_DEBUG_ENABLE(2)) {
+    spi_count += len;
+  }
+  // transfer is done in place, the buffer is sent.
+  std::fill_n(buf, len, 0x00);
+  SPI.transfer(buf, len);
+}
+
 void HalIo::pin_switch_antenna_tx(bool isTx) const {
   // val == 1  => tx 1
   if (lmic_pins.prepare_antenna_tx)
@@ -103,7 +206,72 @@ bool HalIo::io_check1() const {
   return digitalRead(lmic_pins.dio[1]) ? true : false;
 }
 
-void HalIo::init() const {
+void HalIo::wait_io0_low() const {
+#ifdef __AVR__
+  if (busy_irq) {
+    // Idle sleep keep timer0 and SPI running.
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    while (true) {
+      cli();
+      if (!io_check0()) {
+        sei();
+        return;
+      }
+      sleep_enable();
+      // instruction after sei is executed before any interrupt: the falling
+      // edge cannot be missed between the check and the sleep.
+      sei();
+      sleep_cpu();
+      sleep_disable();
+    }
+  }
+#elif defined(ARDUINO_ARCH_ESP32)
+  if (busy_irq) {
+    // an edge between the check and the take is kept by the semaphore, the
+    // 1 tick timeout only covers a stale give of the other radio.
+    while (io_check0()) {
+      xSemaphoreTake(busy_semaphore, 1);
+    }
+    return;
+  }
+#endif
+  while (io_check0()) {
+    yield();
+  }
+}
+
+void HalIo::clear_edge() const {
+  if (edge_slot == NO_EDGE_SLOT)
+    return;
+  DisableIRQsGard irqguard;
+  edge_captured &= ~(1 << edge_slot);
+}
+
+void HalIo::store_edge() const {
+  if (edge_slot == NO_EDGE_SLOT)
+    return;
+  EDGE_ISR[edge_slot]();
+}
+
+OsTime HalIo::edge_time() const {
+  OsTime const now = hal_ticks();
+  uint32_t const now_us = micros();
+  if (edge_slot == NO_EDGE_SLOT)
+    return now;
+
+  uint32_t captured_us;
+  {
+    DisableIRQsGard irqguard;
+    if (!(edge_captured & (1 << edge_slot))) {
+      PRINT_DEBUG(2, F("No DIO edge captured"));
+      return now;
+    }
+    captured_us = edge_us[edge_slot];
+  }
+  return now - OsDeltaTime::from_us(now_us - captured_us);
+}
+
+void HalIo::init(uint8_t const edge_dio_mask, bool const busy_on_dio0) {
   // NSS, DIO0 , DIO1 are required for LoRa
   ASSERT(lmic_pins.nss != LMIC_UNUSED_PIN);
   ASSERT(lmic_pins.dio[0] != LMIC_UNUSED_PIN);
@@ -113,6 +281,11 @@ void HalIo::init() const {
               lmic_pins.rst, lmic_pins.dio[0], lmic_pins.dio[1]);
 
   pinMode(lmic_pins.nss, OUTPUT);
+  digitalWrite(lmic_pins.nss, 1);
+#ifdef __AVR__
+  nss_port = portOutputRegister(digitalPinToPort(lmic_pins.nss));
+  nss_mask = digitalPinToBitMask(lmic_pins.nss);
+#endif
 
   if (lmic_pins.rst != LMIC_UNUSED_PIN)
     pinMode(lmic_pins.rst, OUTPUT);
@@ -120,5 +293,36 @@ void HalIo::init() const {
   pinMode(lmic_pins.dio[0], INPUT);
   pinMode(lmic_pins.dio[1], INPUT);
 
+  if (edge_slot == NO_EDGE_SLOT && used_edge_slots < MAX_EDGE_SLOTS) {
+    edge_slot = used_edge_slots++;
+  }
+  // timestamp DIO edges in interrupt if the pin can have one.
+  // (other pins can use store_edge() from a pin change interrupt)
+  for (uint8_t i = 0; i < NUM_DIO && edge_slot != NO_EDGE_SLOT; ++i) {
+    if (!(edge_dio_mask & (1 << i)))
+      continue;
+    auto const irq = digitalPinToInterrupt(lmic_pins.dio[i]);
+    if (irq != NOT_AN_INTERRUPT) {
+      PRINT_DEBUG(2, F("Capture edge on DIO%d"), i);
+      attachInterrupt(irq, EDGE_ISR[edge_slot], RISING);
+    }
+  }
+
+  if (busy_on_dio0 && !(edge_dio_mask & 0x01)) {
+    auto const irq = digitalPinToInterrupt(lmic_pins.dio[0]);
+    busy_irq = irq != NOT_AN_INTERRUPT;
+    if (busy_irq) {
+      PRINT_DEBUG(2, F("Sleep on busy DIO0"));
+#ifdef ARDUINO_ARCH_ESP32
+      if (!busy_semaphore) {
+        busy_semaphore = xSemaphoreCreateBinary();
+      }
+#endif
+      attachInterrupt(irq, busy_falling, FALLING);
+    }
+  }
+
   // configure radio SPI
 }
+
+#endif
@@ -3,6 +3,9 @@
 #pragma once
 
 #include "../lmic/osticks.h"
+#ifdef ARDUINO
+#include <SPI.h>
+#endif
 #include <stdint.h>
 
 constexpr uint8_t NUM_DIO = 2;
@@ -14,8 +17,12 @@ struct lmic_pinmap {
   prepare_antenna_type* prepare_antenna_tx;
   uint8_t rst;
   uint8_t dio[NUM_DIO];
+  // SPI clock in Hz, 0 for default (10MHz).
+  uint32_t spi_freq;
 };
 
+constexpr uint32_t DEFAULT_SPI_FREQ = 10000000;
+
 // Use this for any unused pins.
 const uint8_t LMIC_UNUSED_PIN = 0xff;
 
@@ -43,6 +50,21 @@ public:
    */
   uint8_t spi(uint8_t outval) const;
 
+  /**
+   * write 'len' bytes of 'buf' in one block, received bytes are ignored.
+   */
+  void spi_write(uint8_t const *buf, uint8_t len) const;
+
+  /**
+   * read 'len' bytes in 'buf' in one block (send 0x00).
+   */
+  void spi_read(uint8_t *buf, uint8_t len) const;
+
+  /**
+   * Number of bytes exchanged on SPI (only counted with debug level 2).
+   */
+  uint16_t spi_bytes() const { return spi_count; }
+
   /**
    * drive radio RX/TX pins (false=rx, true=tx).
    */
@@ -68,11 +90,48 @@ public:
    */
   bool io_check1() const;
 
+  /**
+   * Wait until pin DI0 (busy) is low.
+   * The MCU sleeps until the falling edge if the pin has an interrupt (idle
+   * sleep on AVR, task blocked on a semaphore on ESP32).
+   */
+  void wait_io0_low() const;
+
+  /**
+   * Forget previous DIO edge, call it just before starting a radio operation.
+   */
+  void clear_edge() const;
+
+  /**
+   * Store current time as DIO edge (for application pin change interrupt).
+   */
+  void store_edge() const;
+
+  /**
+   * Return time of first DIO rising edge since clear_edge().
+   * Return current time if no edge was captured.
+   */
+  OsTime edge_time() const;
+
   // configure radio I/O and interrupt handler and SPI
-  void init() const;
+  // edge_dio_mask : DIO pins signaling end of operation (bit 0 => DIO0)
+  // busy_on_dio0 : DIO0 is a busy pin, wake up the MCU on its falling edge.
+  void init(uint8_t edge_dio_mask, bool busy_on_dio0 = false);
 
 private:
   const lmic_pinmap &lmic_pins;
+  uint8_t edge_slot = 0xFF;
+  // falling edge of busy pin wake up the MCU.
+  bool busy_irq = false;
+  mutable uint16_t spi_count = 0;
+#ifdef ARDUINO
+  SPISettings spi_settings;
+#endif
+#ifdef __AVR__
+  // direct access to NSS port (digitalWrite is slow)
+  volatile uint8_t *nss_port = nullptr;
+  uint8_t nss_mask = 0;
+#endif
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+/*******************************************************************************
+ * HAL for host build without Arduino (unit tests).
+ *
+ * Time is simulated: it moves one tick at each read and jumps on waits, so
+ * busy loops always end. SPI and DIO pins are given by the HalNativeRadio
+ * attached to the NSS pin.
+ *******************************************************************************/
+
+#ifndef ARDUINO
+#include "hal.h"
+#include "hal_io.h"
+#include "print_debug.h"
+#include <stdlib.h>
+
+// -----------------------------------------------------------------------------
+// TIME
+
+namespace {
+uint32_t now_ticks = 0;
+} // namespace
+
+OsTime hal_ticks() { return OsTime(++now_ticks); }
+
+void hal_add_time_in_sleep(OsDeltaTime nb_tick) {
+  now_ticks += nb_tick.tick();
+}
+
+void hal_waitUntil(OsTime time) { hal_wait(time - hal_ticks()); }
+
+void hal_wait(OsDeltaTime delta) {
+  if (delta > OsDeltaTime(0)) {
+    now_ticks += delta.tick();
+  }
+}
+
+DisableIRQsGard::DisableIRQsGard() { ++intNumber; }
+DisableIRQsGard::~DisableIRQsGard() { --intNumber; }
+uint8_t DisableIRQsGard::intNumber = 0;
+
+// -----------------------------------------------------------------------------
+
+void hal_init() {}
+
+void hal_printf_init() {}
+
+void hal_failed(const char *file, uint16_t line) {
+  fprintf(stderr, "FAILURE %s:%u\n", file, line);
+  abort();
+}
+
+// -----------------------------------------------------------------------------
+// RADIO I/O
+
+namespace {
+// one model by radio, found with its NSS pin.
+constexpr uint8_t MAX_RADIOS = 2;
+struct AttachedRadio {
+  uint8_t nss;
+  HalNativeRadio *radio;
+};
+AttachedRadio attached[MAX_RADIOS] = {{LMIC_UNUSED_PIN, nullptr},
+                                      {LMIC_UNUSED_PIN, nullptr}};
+
+HalNativeRadio *radio_on(uint8_t const nss) {
+  for (auto const &slot : attached) {
+    if (slot.radio && slot.nss == nss) {
+      return slot.radio;
+    }
+  }
+  return nullptr;
+}
+
+bool dio_high(uint8_t const nss, uint8_t const index) {
+  auto const radio = radio_on(nss);
+  return radio && radio->dio(index);
+}
+} // namespace
+
+void hal_native_attach(uint8_t const nss, HalNativeRadio *const radio) {
+  for (auto &slot : attached) {
+    if (slot.radio && slot.nss == nss) {
+      slot.radio = radio;
+      return;
+    }
+  }
+  for (auto &slot : attached) {
+    if (!slot.radio) {
+      slot = AttachedRadio{nss, radio};
+      return;
+    }
+  }
+  hal_failed(__FILE__, __LINE__);
+}
+
+HalIo::HalIo(lmic_pinmap const &pins) : lmic_pins(pins) {}
+
+void HalIo::write_reg(uint8_t const addr, uint8_t const data) const {
+  beginspi();
+  spi(addr | 0x80);
+  spi(data);
+  endspi();
+}
+
+uint8_t HalIo::read_reg(uint8_t const addr) const {
+  beginspi();
+  spi(addr & 0x7F);
+  uint8_t const val = spi(0x00);
+  endspi();
+  return val;
+}
+
+void HalIo::write_buffer(uint8_t const addr, uint8_t const *const buf,
+                         uint8_t const len) const {
+  beginspi();
+  spi(addr | 0x80);
+  spi_write(buf, len);
+  endspi();
+}
+
+void HalIo::read_buffer(uint8_t const addr, uint8_t *const buf,
+                        uint8_t const len) const {
+  beginspi();
+  spi(addr & 0x7F);
+  spi_read(buf, len);
+  endspi();
+}
+
+void HalIo::beginspi() const {
+  if (auto const radio = radio_on(lmic_pins.nss)) {
+    radio->begin_spi();
+  }
+}
+
+void HalIo::endspi() const {
+  if (auto const radio = radio_on(lmic_pins.nss)) {
+    radio->end_spi();
+  }
+}
+
+uint8_t HalIo::spi(uint8_t const out) const {
+  spi_count++;
+  auto const radio = radio_on(lmic_pins.nss);
+  return radio ? radio->spi(out) : 0;
+}
+
+void HalIo::spi_write(uint8_t const *const buf, uint8_t const len) const {
+  for (uint8_t i = 0; i < len; i++) {
+    spi(buf[i]);
+  }
+}
+
+void HalIo::spi_read(uint8_t *const buf, uint8_t const len) const {
+  for (uint8_t i = 0; i < len; i++) {
+    buf[i] = spi(0x00);
+  }
+}
+
+void HalIo::pin_switch_antenna_tx(bool isTx) const {
+  if (lmic_pins.prepare_antenna_tx)
+    lmic_pins.prepare_antenna_tx(isTx);
+}
+
+void HalIo::pin_rst(uint8_t) const {}
+
+bool HalIo::io_check() const {
+  for (uint8_t i = 0; i < NUM_DIO; ++i) {
+    if (dio_high(lmic_pins.nss, i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HalIo::io_check0() const { return dio_high(lmic_pins.nss, 0); }
+
+bool HalIo::io_check1() const { return dio_high(lmic_pins.nss, 1); }
+
+void HalIo::wait_io0_low() const {
+  while (io_check0()) {
+    hal_ticks();
+  }
+}
+
+// no edge capture, the end of operation is the time it is seen.
+void HalIo::clear_edge() const {}
+
+void HalIo::store_edge() const {}
+
+OsTime HalIo::edge_time() const { return hal_ticks(); }
+
+void HalIo::init(uint8_t, bool) {}
+
+#endif
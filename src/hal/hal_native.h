@@ -0,0 +1,54 @@
+/*******************************************************************************
+ * Host build without Arduino (unit tests).
+ *
+ * Replace the Arduino functions used by the library, and let a radio model
+ * answer the SPI transfers of HalIo.
+ *******************************************************************************/
+#ifndef _hal_hal_native_h_
+#define _hal_hal_native_h_
+
+#ifndef ARDUINO
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// constant tables and strings stay in RAM.
+#define PROGMEM
+#define PSTR(str) (str)
+#define PGM_P const char *
+#define printf_P printf
+#define memcpy_P memcpy
+#define pgm_read_byte(addr) (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr) (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_dword(addr) (*reinterpret_cast<const uint32_t *>(addr))
+class __FlashStringHelper;
+#define F(str) (reinterpret_cast<const __FlashStringHelper *>(str))
+
+inline void yield() {}
+
+/**
+ * Radio seen by HalIo: SPI transfers and DIO levels.
+ */
+class HalNativeRadio {
+public:
+  // NSS driven low, start of a transfer.
+  virtual void begin_spi() {}
+  virtual uint8_t spi(uint8_t out) = 0;
+  // NSS driven high.
+  virtual void end_spi() {}
+  /**
+   * Level of pin lmic_pinmap::dio[index] (busy pin is DIO0 on SX126x).
+   */
+  virtual bool dio(uint8_t index) const = 0;
+};
+
+/**
+ * Connect a radio model to the HalIo using this NSS pin, nullptr to remove
+ * it. Without model SPI reads 0 and DIO are low.
+ */
+void hal_native_attach(uint8_t nss, HalNativeRadio *radio);
+
+#endif
+
+#endif // _hal_hal_native_h_
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ * Watchdog period calibration for AVR power down.
+ *
+ * The watchdog run on its own 128kHz oscillator, its period depends on
+ * voltage and temperature. Measure it against the cpu clock (timer0) to
+ * know how long the MCU really slept.
+ *******************************************************************************/
+
+#ifdef __AVR__
+#include "hal.h"
+#include "print_debug.h"
+#include <Arduino.h>
+#include <avr/wdt.h>
+
+// -----------------------------------------------------------------------------
+// WATCHDOG CALIBRATION
+
+namespace {
+// period measured (64ms), long enough for good precision on timer0.
+constexpr uint8_t calibration_wdto = WDTO_60MS;
+// redo the measure after this time (temperature and voltage drift slowly).
+constexpr OsDeltaTime calibration_interval = OsDeltaTime::from_sec(3600);
+// Arduino core configure timer0 with prescaler 64.
+constexpr uint8_t timer0_prescaler = 64;
+
+// measured duration of calibration_wdto, nominal before first calibration.
+OsDeltaTime measured_period = OsDeltaTime::from_ms(64);
+OsTime last_calibration;
+bool calibrated = false;
+
+constexpr uint8_t wdtcsr_prescaler(uint8_t wdto) {
+  return (wdto & 0x08 ? (1 << WDP3) : 0) | (wdto & 0x07);
+}
+
+void write_wdtcsr(uint8_t value) {
+  wdt_reset();
+  // timed sequence to change watchdog configuration
+  WDTCSR = (1 << WDCE) | (1 << WDE);
+  WDTCSR = value;
+}
+} // namespace
+
+void hal_calibrate_wdt() {
+  DisableIRQsGard irqguard;
+  uint8_t const saved_config = WDTCSR & ~(1 << WDIF);
+
+  // interrupt mode, but interrupts are disabled: only WDIF flag is set.
+  write_wdtcsr((1 << WDIF) | (1 << WDIE) | wdtcsr_prescaler(calibration_wdto));
+  uint8_t const start = TCNT0;
+  TIFR0 = (1 << TOV0);
+
+  // count timer0 overflow ourselves until the watchdog timeout
+  uint16_t overflows = 0;
+  while (!(WDTCSR & (1 << WDIF))) {
+    if (TIFR0 & (1 << TOV0)) {
+      TIFR0 = (1 << TOV0);
+      overflows++;
+    }
+  }
+  uint8_t const end = TCNT0;
+  if ((TIFR0 & (1 << TOV0)) && end < 128) {
+    TIFR0 = (1 << TOV0);
+    overflows++;
+  }
+
+  // restore previous watchdog mode and clear flag.
+  write_wdtcsr(saved_config | (1 << WDIF));
+
+  int32_t const counts = (int32_t)overflows * 256 + end - start;
+  OsDeltaTime const elapsed = OsDeltaTime::from_us(
+      clockCyclesToMicroseconds(counts * timer0_prescaler));
+
+  // micros() sees the TCNT0 move (end - start) and a still pending overflow
+  // (its interrupt runs after the guard), only the overflows cleared above
+  // are lost.
+  int32_t const lost_counts = (int32_t)overflows * 256;
+  hal_add_time_in_sleep(OsDeltaTime::from_us(
+      clockCyclesToMicroseconds(lost_counts * timer0_prescaler)));
+
+  measured_period = elapsed;
+  last_calibration = hal_ticks();
+  calibrated = true;
+  PRINT_DEBUG(1, F("WDT calibration 64ms => %" PRIi32 " us"), elapsed.to_us());
+}
+
+OsDeltaTime hal_wdt_period(uint8_t const wdto) {
+  if (!calibrated || hal_ticks() - last_calibration > calibration_interval) {
+    hal_calibrate_wdt();
+  }
+  // each watchdog period is the double of the previous one.
+  if (wdto >= calibration_wdto) {
+    return measured_period << (wdto - calibration_wdto);
+  }
+  return OsDeltaTime(measured_period.tick() >> (calibration_wdto - wdto));
+}
+
+#endif
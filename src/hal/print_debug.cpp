@@ -1,3 +1,4 @@
+#ifdef ARDUINO
 #include "../lmic/config.h"
 
 #include "print_debug.h"
@@ -26,3 +27,5 @@ void  hal_printf_init() {
 
 }
 #endif // defined(LMIC_PRINTF_TO)
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef _print_debug_h_
-#define _print_debug_
+#define _print_debug_h_
 
+#ifdef ARDUINO
 #include "WString.h"
+#endif
 #include "hal.h"
 #include "stdio.h"
 
@@ -1,7 +1,10 @@
 #include "lmic/lmic.h"
 #include "lmic/lmic.eu868.h"
 #include "lmic/lmic.us915.h"
+#include "lmic/lmic.ism2400.h"
+#include "lmic/lorap2p.h"
 
 #include "lmic/radio_sx1272.h"
 #include "lmic/radio_sx1276.h"
-#include "lmic/radio_sx1262.h"
\ No newline at end of file
+#include "lmic/radio_sx1262.h"
+#include "lmic/radio_sx1280.h"
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "band.ism2400.h"
+#include "../hal/print_debug.h"
+#include "bufferpack.h"
+#include "oslmic.h"
+
+void BandsIsm2400::init() { avail[0] = os_getTime(); }
+
+void BandsIsm2400::updateBandAvailability(uint8_t const band,
+                                          OsTime const lastusage,
+                                          OsDeltaTime const duration) {
+  avail[band] = lastusage + duration;
+
+  PRINT_DEBUG(2, F("Setting  available time for band %d to %" PRIu32 ""), band,
+              avail[band].tick());
+}
+
+void BandsIsm2400::print_state() const {
+  PRINT_DEBUG(2, F("Band 0, available at %" PRIu32 "."), avail[0].tick());
+}
+
+uint8_t BandsIsm2400::getBandForFrequency(uint32_t const) { return 0; }
+
+#if defined(ENABLE_SAVE_RESTORE)
+
+void BandsIsm2400::saveState(StoringAbtract &store) const {
+  store.write(avail[0]);
+}
+
+void BandsIsm2400::loadState(RetrieveAbtract &store) { store.read(avail[0]); }
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef lmic_ism2400_h
+#define lmic_ism2400_h
+
+#include <stdint.h>
+
+#include "bufferpack.h"
+#include "osticks.h"
+
+/**
+ * 2.4GHz ISM band: no duty cycle, a single band available again at the end
+ * of the last transmission.
+ */
+class BandsIsm2400 {
+public:
+  void init();
+  void updateBandAvailability(uint8_t band, OsTime lastusage,
+                              OsDeltaTime duration);
+  void print_state() const;
+  OsTime getAvailability(uint8_t band) { return avail[band]; };
+
+  static constexpr uint8_t MAX_BAND = 1;
+  static uint8_t getBandForFrequency(uint32_t frequency);
+
+#if defined(ENABLE_SAVE_RESTORE)
+
+  void saveState(StoringAbtract &store) const;
+  void loadState(RetrieveAbtract &store);
+#endif
+
+private:
+  OsTime avail[MAX_BAND];
+};
+
+#endif
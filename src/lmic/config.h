@@ -12,6 +12,16 @@
 // the HopeRF RFM95 boards.
 #define CFG_sx1276_radio 1
 
+// Bind the MAC to one radio driver at compile time (e.g. with build flag
+// -DLMIC_STATIC_RADIO=RadioSx1276): radio functions are no more virtual
+// (no vtable) and small ones can be inlined, other drivers can not be used.
+//#define LMIC_STATIC_RADIO RadioSx1276
+
+// SX127x outputs wired to the antenna, PA_BOOST only by default (RFM95W).
+// With both, RFO is used up to 15dBm as it draws less current.
+//#define LMIC_SX127X_RFO
+//#define LMIC_SX127X_RFO_AND_PA_BOOST
+
 // 16 μs per tick
 // LMIC requires ticks to be 15.5μs - 100 μs long
 #define US_PER_OSTICK_EXPONENT 4
@@ -59,6 +69,11 @@ constexpr int debugLevel = 1;
 // example).
 //#define DISABLE_INVERT_IQ_ON_RX
 
+// Bytes of the LoraP2p TX queue, each frame takes its length plus one.
+#ifndef LMIC_P2P_QUEUE_SIZE
+#define LMIC_P2P_QUEUE_SIZE 256
+#endif
+
 #define CFG_noassert
 
 #endif // _lmic_config_h_
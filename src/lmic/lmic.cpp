@@ -24,6 +24,12 @@ using namespace lorawan;
 
 constexpr uint8_t MINRX_SYMS = 5;
 constexpr uint8_t PAMBL_SYMS = 8;
+// FSK preamble in bytes (one FSK "symbol" is one byte).
+constexpr uint8_t PAMBL_FSK = 5;
+// wake up before the measured setup time with this margin.
+constexpr OsDeltaTime RAMPUP_MARGIN = OsDeltaTime::from_us(500);
+// setup longer than this are not a measure (job rescheduled...).
+constexpr OsDeltaTime MAX_RAMPUP = OsDeltaTime::from_ms(50);
 
 // ================================================================================
 // BEG OS - default implementations for certain OS suport functions
@@ -56,6 +62,15 @@ int16_t getSensitivity(rps_t rps) {
 }
 
 OsDeltaTime Lmic::calcAirTime(rps_t rps, uint8_t plen) {
+  if (rps.sf == FSK) {
+    // 50kbps : preamble 5, sync word 3, length 1, CRC 2 bytes.
+    OsDeltaTime val = OsDeltaTime(((int32_t)(plen + 5 + 3 + 1 + 2) * 8 *
+                                       OSTICKS_PER_SEC +
+                                   25000) /
+                                  50000);
+    PRINT_DEBUG(1, F("Time on air : %i ms"), val.to_ms());
+    return val;
+  }
   // BW 0,1,2 = 125,250,500kHz
   const uint8_t bw = rps.bwRaw;
   // SF 7..12 = SF7..12
@@ -73,6 +88,14 @@ OsDeltaTime Lmic::calcAirTime(rps_t rps, uint8_t plen) {
     tmp = 8;
   }
   tmp = (tmp << 2) + /*preamble*/ 49 /* 4 * (8 + 4.25) */;
+  if (rps.getBw() == BandWidth::BW800) {
+    // SX1280 always use 4 * (SF - 2) bits by symbol for SF11 and SF12 (as
+    // computed above).
+    // quarter symbol = 2^sf / 812500Hz / 4 = 2^sf * 4 / 13 us
+    OsDeltaTime val = OsDeltaTime::from_us(((int32_t)tmp << sf) * 4 / 13);
+    PRINT_DEBUG(1, F("Time on air : %i ms"), val.to_ms());
+    return val;
+  }
   // bw = 125000 = 15625 * 2^3
   //      250000 = 15625 * 2^4
   //      500000 = 15625 * 2^5
@@ -479,7 +502,10 @@ void Lmic::setupRx1() {
   dataLen = 0;
   auto parameters = getRx1Parameter();
   rps_t rps = dndr2rps(parameters.datarate);
+  radio.set_rx_gain(rx1Gain);
   radio.rx(parameters.frequency, rps, rxsyms, rxtime);
+  updateRampup(rxRampup, radio.last_ready_time() -
+                             (rxtime - (rxRampup + RAMPUP_MARGIN)));
   wait_end_rx();
 }
 
@@ -487,7 +513,10 @@ void Lmic::setupRx2() {
   txrxFlags.reset().set(TxRxStatus::DNW2);
   dataLen = 0;
   rps_t const rps = dndr2rps(rx2Parameter.datarate);
+  radio.set_rx_gain(rx2Gain);
   radio.rx(rx2Parameter.frequency, rps, rxsyms, rxtime);
+  updateRampup(rxRampup, radio.last_ready_time() -
+                             (rxtime - (rxRampup + RAMPUP_MARGIN)));
   wait_end_rx();
 }
 
@@ -518,10 +547,28 @@ OsTime Lmic::schedRx12(OsDeltaTime delay, dr_t dr) {
 
   // Center the receive window on the center of the expected preamble
   // (again note that hsym is half a sumbol time, so no /2 needed)
-  rxtime = txend + (delay + (PAMBL_SYMS - rxsyms) * hsym);
+  uint8_t const pambl = dndr2rps(dr).sf == FSK ? PAMBL_FSK : PAMBL_SYMS;
+  rxtime = txend + (delay + (pambl - rxsyms) * hsym);
   PRINT_DEBUG(1, F("Rx delay : %i ms"), (rxtime - txend).to_ms());
 
-  return (rxtime - RX_RAMPUP);
+  // a calibration before RX is not in the measured rampup.
+  return rxtime - (rxRampup + RAMPUP_MARGIN) -
+         radio.calibration_rampup(rxtime);
+}
+
+// Setup time from wake up to radio ready.
+// Follow at once a longer setup, decrease slowly to the shorter ones.
+void Lmic::updateRampup(OsDeltaTime &rampup, OsDeltaTime const measured) {
+  if (measured > MAX_RAMPUP || measured < OsDeltaTime(0)) {
+    return;
+  }
+  if (measured > rampup) {
+    rampup = measured;
+  } else {
+    rampup -= OsDeltaTime((rampup.tick() - measured.tick()) / 8);
+  }
+  PRINT_DEBUG(2, F("Setup %" PRIi32 " us, rampup %" PRIi32 " us"),
+              measured.to_us(), rampup.to_us());
 }
 
 // Called by HAL once TX complete and delivers exact end of TX time stamp in
@@ -622,7 +669,10 @@ bool Lmic::processJoinAccept() {
   stateJustJoined();
 
   const uint8_t dlSettings = frame[join_accept::offset::dlSettings];
-  rx2Parameter.datarate = dlSettings & 0x0F;
+  const dr_t rx2Dr = dlSettings & 0x0F;
+  if (validDR(rx2Dr)) {
+    rx2Parameter.datarate = rx2Dr;
+  }
   rx1DrOffset = (dlSettings >> 4) & 0x7;
 
   const uint8_t configuredRxDelay = frame[join_accept::offset::rxDelay];
@@ -984,12 +1034,25 @@ void Lmic::engineUpdate() {
   }
 
   // Earliest possible time vs overhead to setup radio
-  if (txbeg >= (now + TX_RAMPUP)) {
+  OsDeltaTime const txSetup = txRampup + RAMPUP_MARGIN;
+  OsDeltaTime const txCalibration = radio.calibration_rampup(txbeg);
+  if (txbeg >= (now + txSetup + txCalibration)) {
     PRINT_DEBUG(1, F("Uplink delayed until %" PRIu32), txbeg.tick());
     // Cannot yet TX
-    //  wait for the time to TX
-    osjob.setTimedCallback(txbeg - TX_RAMPUP, &Lmic::runEngineUpdate);
+    //  wait for the time to TX, calibration (if due) is started before.
+    txWakeup = txbeg - txSetup;
+    txWakeupPending = true;
     txend = txbeg;
+    if (txCalibration.tick() != 0) {
+      osjob.setTimedCallback(txWakeup - txCalibration,
+                             &Lmic::runTxCalibration);
+    } else {
+      osjob.setTimedCallback(txWakeup, &Lmic::runEngineUpdate);
+    }
+    return;
+  }
+
+  if (deferOnBusyChannel()) {
     return;
   }
 
@@ -1028,17 +1091,71 @@ void Lmic::engineUpdate() {
   PRINT_DEBUG(2, F("Updating global duty avail to %" PRIu32 ""),
               globalDutyAvail.tick());
 
-  radio.tx(getTxFrequency(), rps, getTxPower() + antennaPowerAdjustment, frame,
-           dataLen);
+  radio.prepare_tx(getTxFrequency(), rps,
+                   getTxPower() + antennaPowerAdjustment, frame, dataLen);
+  if (txWakeupPending) {
+    updateRampup(txRampup, os_getTime() - txWakeup);
+    txWakeupPending = false;
+  }
+  // start exactly at planned time (radio is ready)
+  hal_waitUntil(txbeg);
+  radio.start_tx();
   wait_end_tx();
 }
 
+// the radio calibrates while other jobs run, TX setup waits for its end.
+void Lmic::runTxCalibration() {
+  radio.start_calibration(txend);
+  osjob.setTimedCallback(txWakeup, &Lmic::runEngineUpdate);
+}
+
 void Lmic::setAntennaPowerAdjustment(int8_t power) {
   antennaPowerAdjustment = power;
 }
 
+void Lmic::setListenBeforeTalk(uint8_t const maxRetry) {
+  lbtMaxRetry = maxRetry;
+  lbtRetry = 0;
+}
+
+void Lmic::setRxGain(RxGain const rx1, RxGain const rx2) {
+  rx1Gain = rx1;
+  rx2Gain = rx2;
+}
+
+// Listen before talk.
+// Return true if uplink is deferred because the channel is busy.
+bool Lmic::deferOnBusyChannel() {
+  rps_t const rps = updr2rps(datarate);
+  // CAD only detects LoRa preambles.
+  if (lbtMaxRetry == 0 || rps.sf == FSK) {
+    return false;
+  }
+  if (!radio.channel_activity(getTxFrequency(), rps)) {
+    lbtRetry = 0;
+    return false;
+  }
+  if (lbtRetry >= lbtMaxRetry) {
+    PRINT_DEBUG(1, F("Channel busy, send anyway"));
+    lbtForcedCount++;
+    lbtRetry = 0;
+    return false;
+  }
+  lbtRetry++;
+  lbtDeferredCount++;
+  // the back-off is not radio setup, do not measure it.
+  txWakeupPending = false;
+  // random back-off (0 to 1s), then on another channel.
+  auto const backoff = OsDeltaTime::from_ms(rand.uint8() * 4);
+  PRINT_DEBUG(1, F("Channel busy, retry in %" PRIi32 " ms"), backoff.to_ms());
+  opmode.set(OpState::NEXTCHNL);
+  osjob.setTimedCallback(os_getTime() + backoff, &Lmic::runEngineUpdate);
+  return true;
+}
+
 void Lmic::shutdown() {
   osjob.clearCallback();
+  txWakeupPending = false;
   radio.rst();
   opmode.set(OpState::SHUTDOWN);
 }
@@ -1046,6 +1163,7 @@ void Lmic::shutdown() {
 void Lmic::reset() {
   radio.rst();
   osjob.clearCallback();
+  txWakeupPending = false;
   devaddr = 0;
   devNonce = rand.uint16();
   opmode.reset();
@@ -1057,9 +1175,42 @@ void Lmic::reset() {
   initDefaultChannels();
 }
 
-void Lmic::init() {
+void Lmic::init(bool const seedFromRadio) {
   radio.init();
-  rand.init(radio);
+  if (seedFromRadio) {
+    rand.init(radio);
+  }
+  initDone();
+}
+
+void Lmic::initAsync(bool const seedFromRadio) {
+  radioSeed = seedFromRadio;
+  opmode.reset().set(OpState::SHUTDOWN);
+  osjob.setCallbackRunnable(&Lmic::runInitStep);
+}
+
+void Lmic::runInitStep() {
+  OsDeltaTime const wait = radio.init_step();
+  if (wait.tick() != 0) {
+    osjob.setTimedCallback(os_getTime() + wait, &Lmic::runInitStep);
+    return;
+  }
+  // radio noise is sampled in its own job, the radio is ready.
+  osjob.setCallbackRunnable(&Lmic::runInitRandom);
+}
+
+// blocking: a few ms of radio RX (and calibration on SX126x).
+void Lmic::runInitRandom() {
+  if (radioSeed) {
+    rand.init(radio);
+  }
+  initDone();
+  reportEvent(EventType::READY);
+}
+
+void Lmic::initDone() {
+  rxRampup = radio.rx_rampup();
+  txRampup = radio.tx_rampup();
   opmode.reset().set(OpState::SHUTDOWN);
 }
 
@@ -1069,6 +1220,7 @@ void Lmic::clrTxData() {
   if (opmode.test(OpState::JOINING)) // do not interfere with JOINING
     return;
   osjob.clearCallback();
+  txWakeupPending = false;
   radio.rst();
   engineUpdate();
 }
@@ -1178,21 +1330,9 @@ dr_t Lmic::lowerDR(dr_t dr, uint8_t n) const {
   return dr;
 }
 
-OsTime Lmic::int_trigger_time() const {
-  OsTime const now = os_getTime();
-  auto const diff = now - last_int_trigger;
-  if (diff > OsDeltaTime(0) && diff < OsDeltaTime::from_sec(1)) {
-    return last_int_trigger;
-  } else {
-    PRINT_DEBUG(1, F("Not using interupt trigger %" PRIu32 ""),
-                last_int_trigger.tick());
-    return now;
-  }
-}
-
 void Lmic::wait_end_rx() {
   if (radio.io_check()) {
-    const auto now = int_trigger_time();
+    const auto now = radio.operation_end_time();
 
     dataLen = radio.handle_end_rx(frame);
 
@@ -1215,9 +1355,14 @@ void Lmic::wait_end_rx() {
 void Lmic::wait_end_tx() {
   if (radio.io_check()) {
     // save exact tx time
-    txend = int_trigger_time();
+    txend = radio.operation_end_time();
 
-    radio.handle_end_tx();
+    // RX1 window follows.
+    OsDeltaTime idle = opmode.test(OpState::JOINING)
+                           ? OsDeltaTime::from_sec(DELAY_JACC1)
+                           : rxDelay;
+    idle -= rxRampup;
+    radio.handle_end_tx(idle);
 
     PRINT_DEBUG(1, F("End TX  %" PRIu32 ""), txend.tick());
 
@@ -1233,7 +1378,7 @@ void Lmic::wait_end_tx() {
   }
 }
 
-void Lmic::store_trigger() { last_int_trigger = os_getTime(); }
+void Lmic::store_trigger() { radio.store_trigger(); }
 
 #if defined(ENABLE_SAVE_RESTORE)
 void Lmic::saveState(StoringAbtract &store) const {
@@ -1277,6 +1422,7 @@ void Lmic::saveStateWithoutTimeData(StoringAbtract &store) const {
   store.write(dn2Ans);
 #endif
   aes.saveState(store);
+  rand.saveState(store);
 }
 
 void Lmic::loadState(RetrieveAbtract &store) {
@@ -1320,9 +1466,10 @@ void Lmic::loadStateWithoutTimeData(RetrieveAbtract &store) {
   store.read(dn2Ans);
 #endif
   aes.loadState(store);
+  rand.loadState(store);
 }
 
 #endif
 
-Lmic::Lmic(Radio &aradio, OsScheduler &ascheduler)
+Lmic::Lmic(LmicRadio &aradio, OsScheduler &ascheduler)
     : radio(aradio), osjob(*this, ascheduler), rand(aes) {}
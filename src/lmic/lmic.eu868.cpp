@@ -55,10 +55,12 @@ constexpr uint8_t rps_DR5 =
     rps_t{SF7, BandWidth::BW125, CodingRate::CR_4_5, false}.rawValue();
 constexpr uint8_t rps_DR6 =
     rps_t{SF7, BandWidth::BW250, CodingRate::CR_4_5, false}.rawValue();
+constexpr uint8_t rps_DR7 =
+    rps_t{FSK, BandWidth::BW125, CodingRate::CR_4_5, false}.rawValue();
 
 CONST_TABLE(uint8_t, _DR2RPS_CRC)
 [] = {ILLEGAL_RPS, rps_DR0, rps_DR1, rps_DR2,    rps_DR3,
-      rps_DR4,     rps_DR5, rps_DR6, ILLEGAL_RPS};
+      rps_DR4,     rps_DR5, rps_DR6, rps_DR7};
 
 constexpr int8_t MaxEIRP = 16;
 
@@ -82,13 +84,18 @@ CONST_TABLE(int32_t, DR2HSYM)
     OsDeltaTime::from_us_round(128 << 3).tick(), // DR_SF8
     OsDeltaTime::from_us_round(128 << 2).tick(), // DR_SF7
     OsDeltaTime::from_us_round(128 << 1).tick(), // DR_SF7B
-    OsDeltaTime::from_us_round(80).tick() // FSK -- not used (time for 1/2 byte)
+    OsDeltaTime::from_us_round(80).tick() // FSK (time for 1/2 byte)
 };
 
 } // namespace
 
 uint8_t LmicEu868::getRawRps(dr_t const dr) const {
-  return TABLE_GET_U1(_DR2RPS_CRC, dr + 1);
+  // dr - 1 (255) wrap to the first element.
+  auto const index = static_cast<uint8_t>(dr + 1);
+  if (index >= sizeof(RESOLVE_TABLE(_DR2RPS_CRC))) {
+    return ILLEGAL_RPS;
+  }
+  return TABLE_GET_U1(_DR2RPS_CRC, index);
 }
 
 int8_t LmicEu868::pow2dBm(uint8_t const powerIndex) const {
@@ -102,6 +109,10 @@ int8_t LmicEu868::pow2dBm(uint8_t const powerIndex) const {
 OsDeltaTime LmicEu868::getDwn2SafetyZone() const { return DNW2_SAFETY_ZONE; }
 
 OsDeltaTime LmicEu868::dr2hsym(dr_t const dr) const {
+  // out of table, not a RX data rate.
+  if (dr >= sizeof(RESOLVE_TABLE(DR2HSYM)) / sizeof(int32_t)) {
+    return OsDeltaTime(0);
+  }
   return OsDeltaTime(TABLE_GET_S4(DR2HSYM, dr));
 }
 
@@ -330,5 +341,5 @@ void LmicEu868::loadState(RetrieveAbtract &store) {
 }
 #endif
 
-LmicEu868::LmicEu868(Radio &aradio, OsScheduler &ascheduler)
+LmicEu868::LmicEu868(LmicRadio &aradio, OsScheduler &ascheduler)
     : Lmic(aradio, ascheduler) {}
\ No newline at end of file
@@ -17,8 +17,8 @@
 #include "enumflagsvalue.h"
 #include "lmicrand.h"
 #include "lorabase.h"
+#include "lmicradio.h"
 #include "oslmic.h"
-#include "radio.h"
 
 // LMIC version
 #define LMIC_VERSION_MAJOR 1
@@ -78,7 +78,9 @@ enum class EventType : uint8_t {
   TXCOMPLETE,
   RESET,
   LINK_DEAD,
-  LINK_ALIVE
+  LINK_ALIVE,
+  // radio ready after initAsync()
+  READY
 };
 
 using eventCallback_t = void (*)(EventType);
@@ -109,12 +111,12 @@ public:
   static OsDeltaTime calcAirTime(rps_t rps, uint8_t plen);
 
 private:
-  Radio &radio;
+  LmicRadio &radio;
+  // initAsync() samples radio noise for the random generator.
+  bool radioSeed = true;
   OsJobType<Lmic> osjob;
   // Radio settings TX/RX (also accessed by HAL)
   OsTime rxtime;
-  // time of detect of change of state of radio module
-  OsTime last_int_trigger;
   uint8_t rxsyms = 0;
 
   eventCallback_t eventCallBack = nullptr;
@@ -134,6 +136,25 @@ private:
   OpStateValue opmode;
 
   int8_t antennaPowerAdjustment = 0;
+
+  // receiver gain of RX1 and RX2 windows
+  RxGain rx1Gain = RxGain::BOOSTED;
+  RxGain rx2Gain = RxGain::BOOSTED;
+
+  // listen before talk: max CAD deferral for one uplink (0 = disabled)
+  uint8_t lbtMaxRetry = 0;
+  // CAD deferral of current uplink
+  uint8_t lbtRetry = 0;
+  // number of uplinks deferred by CAD
+  uint16_t lbtDeferredCount = 0;
+  // number of uplinks sent on busy channel after max retry
+  uint16_t lbtForcedCount = 0;
+  // setup time before RX/TX, nominal from radio then measured.
+  OsDeltaTime rxRampup;
+  OsDeltaTime txRampup;
+  // planned wake up for delayed TX (valid if txWakeupPending)
+  OsTime txWakeup;
+  bool txWakeupPending = false;
   // last time we increase duty rate for back-off
   OsTime lastDutyRateBackOff;
   // max rate: 1/2^k
@@ -229,11 +250,16 @@ private:
   void setupRx1();
   void setupRx2();
   OsTime schedRx12(OsDeltaTime delay, dr_t dr);
+  static void updateRampup(OsDeltaTime &rampup, OsDeltaTime measured);
 
   void txDone(OsDeltaTime delay);
 
   void runReset();
+  void runInitStep();
+  void runInitRandom();
+  void initDone();
   void runEngineUpdate();
+  void runTxCalibration();
 
   void onJoinFailed();
   void processJoinAcceptNoJoinFrame();
@@ -277,6 +303,7 @@ private:
   bool decodeFrame();
   void processDnData();
   void txDelay(OsTime reftime, uint8_t secSpan);
+  bool deferOnBusyChannel();
   void resetAdrCount();
   void incrementAdrCount();
 
@@ -296,9 +323,41 @@ public:
    * Adjust output power by this amount (for antenna gain)
    */
   void setAntennaPowerAdjustment(int8_t power);
+
+  /**
+   * Check channel with CAD before each uplink, on activity wait a random
+   * delay and try another channel, up to maxRetry times (0 to disable).
+   */
+  void setListenBeforeTalk(uint8_t maxRetry);
+  uint16_t getLbtDeferredCount() const { return lbtDeferredCount; };
+  uint16_t getLbtForcedCount() const { return lbtForcedCount; };
+  /**
+   * Receiver gain of each RX window (boosted by default).
+   */
+  void setRxGain(RxGain rx1, RxGain rx2);
+  /**
+   * Measured time to setup radio before RX window / TX (wake up included).
+   */
+  OsDeltaTime getRxRampup() const { return rxRampup; };
+  OsDeltaTime getTxRampup() const { return txRampup; };
   bool startJoining();
 
-  void init();
+  /**
+   * Reset and configure the radios (blocking), then seed the random
+   * generator with radio noise. With radioSeed false the noise is not
+   * sampled: the generator is then seeded only by the time and the state
+   * restored by loadState() (wake up from deep sleep), load it before the
+   * first join or channel busy back-off.
+   */
+  void init(bool radioSeed = true);
+  /**
+   * Same as init() from the scheduler: the radio reset runs as non blocking
+   * steps, then a last job samples radio noise for the random generator
+   * (blocks a few ms) and EventType::READY is reported. Other jobs can run
+   * meanwhile, the MAC must not be used before.
+   * radioSeed as for init().
+   */
+  void initAsync(bool radioSeed = true);
   void shutdown();
   void reset();
   void setDevKey(const AesKey &key) { aes.setDevKey(key); };
@@ -374,12 +433,11 @@ protected:
   // decrease data rate by n steps
   dr_t lowerDR(dr_t dr, uint8_t n) const;
 
-  OsTime int_trigger_time() const;
   void wait_end_rx();
   void wait_end_tx();
 
 public:
-  explicit Lmic(Radio &radio, OsScheduler &scheduler);
+  explicit Lmic(LmicRadio &radio, OsScheduler &scheduler);
   void store_trigger();
 };
 
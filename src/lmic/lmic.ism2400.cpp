@@ -0,0 +1,294 @@
+/*******************************************************************************
+ * Copyright (c) 2014-2015 IBM Corporation.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors:
+ *    IBM Zurich Research Lab - initial API, implementation and documentation
+ *    Nicolas Graziano - cpp style.
+ *******************************************************************************/
+
+//! \file
+#include "../hal/print_debug.h"
+
+#include "bufferpack.h"
+#include "lmic.ism2400.h"
+#include "lmic_table.h"
+
+// Default frequency plan for 2.4GHz ISM band (no duty cycle)
+namespace {
+constexpr uint32_t ISM2400_F1 = 2403000000; // SF7-12
+constexpr uint32_t ISM2400_F2 = 2425000000; // SF7-12
+constexpr uint32_t ISM2400_F3 = 2479000000; // SF7-12
+
+constexpr uint32_t ISM2400_FREQ_MIN = 2400000000;
+constexpr uint32_t ISM2400_FREQ_MAX = 2500000000;
+constexpr uint32_t FREQ_DNW2 = 2423000000;
+constexpr LmicIsm2400::Dr DR_DNW2 = LmicIsm2400::Dr::SF12;
+
+constexpr OsDeltaTime DNW2_SAFETY_ZONE = OsDeltaTime::from_ms(3000);
+
+constexpr uint8_t rps_DR0 =
+    rps_t{SF12, BandWidth::BW800, CodingRate::CR_4_5, false}.rawValue();
+constexpr uint8_t rps_DR1 =
+    rps_t{SF11, BandWidth::BW800, CodingRate::CR_4_5, false}.rawValue();
+constexpr uint8_t rps_DR2 =
+    rps_t{SF10, BandWidth::BW800, CodingRate::CR_4_5, false}.rawValue();
+constexpr uint8_t rps_DR3 =
+    rps_t{SF9, BandWidth::BW800, CodingRate::CR_4_5, false}.rawValue();
+constexpr uint8_t rps_DR4 =
+    rps_t{SF8, BandWidth::BW800, CodingRate::CR_4_5, false}.rawValue();
+constexpr uint8_t rps_DR5 =
+    rps_t{SF7, BandWidth::BW800, CodingRate::CR_4_5, false}.rawValue();
+
+CONST_TABLE(uint8_t, _DR2RPS_CRC)
+[] = {ILLEGAL_RPS, rps_DR0, rps_DR1, rps_DR2, rps_DR3, rps_DR4, rps_DR5};
+
+constexpr int8_t MaxEIRP = 10;
+
+// Symbol time at 812.5kHz is 2^sf * 16 / 13 us.
+// Times for half symbol per DR
+CONST_TABLE(int32_t, DR2HSYM)
+[] = {
+    OsDeltaTime::from_us_round((8 << 12) / 13).tick(), // DR_SF12
+    OsDeltaTime::from_us_round((8 << 11) / 13).tick(), // DR_SF11
+    OsDeltaTime::from_us_round((8 << 10) / 13).tick(), // DR_SF10
+    OsDeltaTime::from_us_round((8 << 9) / 13).tick(),  // DR_SF9
+    OsDeltaTime::from_us_round((8 << 8) / 13).tick(),  // DR_SF8
+    OsDeltaTime::from_us_round((8 << 7) / 13).tick(),  // DR_SF7
+};
+
+} // namespace
+
+uint8_t LmicIsm2400::getRawRps(dr_t const dr) const {
+  // dr - 1 (255) wrap to the first element.
+  auto const index = static_cast<uint8_t>(dr + 1);
+  if (index >= sizeof(RESOLVE_TABLE(_DR2RPS_CRC))) {
+    return ILLEGAL_RPS;
+  }
+  return TABLE_GET_U1(_DR2RPS_CRC, index);
+}
+
+int8_t LmicIsm2400::pow2dBm(uint8_t const powerIndex) const {
+  if (powerIndex >= 8) {
+    return InvalidPower;
+  }
+
+  return MaxEIRP - 2 * powerIndex;
+}
+
+OsDeltaTime LmicIsm2400::getDwn2SafetyZone() const { return DNW2_SAFETY_ZONE; }
+
+OsDeltaTime LmicIsm2400::dr2hsym(dr_t const dr) const {
+  // out of table, not a RX data rate.
+  if (dr >= sizeof(RESOLVE_TABLE(DR2HSYM)) / sizeof(int32_t)) {
+    return OsDeltaTime(0);
+  }
+  return OsDeltaTime(TABLE_GET_S4(DR2HSYM, dr));
+}
+
+bool LmicIsm2400::validRx1DrOffset(uint8_t const drOffset) const {
+  return drOffset < 6;
+}
+
+void LmicIsm2400::initDefaultChannels() {
+  PRINT_DEBUG(2, F("Init Default Channel"));
+
+  channels.disableAll();
+  channels.init();
+  setupChannel(0, ISM2400_F1, 0);
+  setupChannel(1, ISM2400_F2, 0);
+  setupChannel(2, ISM2400_F3, 0);
+}
+
+bool LmicIsm2400::setupChannel(uint8_t const chidx, uint32_t const newfreq,
+                               uint16_t const drmap) {
+  if (chidx >= MAX_CHANNELS)
+    return false;
+
+  channels.configure(chidx, newfreq,
+                     drmap == 0 ? dr_range_map(Dr::SF12, Dr::SF7) : drmap);
+  return true;
+}
+
+void LmicIsm2400::disableChannel(uint8_t const channel) {
+  channels.disable(channel);
+}
+
+uint32_t LmicIsm2400::convFreq(const uint8_t *ptr) const {
+  // frequency in step of 200Hz
+  uint32_t newfreq = rlsbf3(ptr) * 200;
+  if (newfreq < ISM2400_FREQ_MIN || newfreq > ISM2400_FREQ_MAX)
+    newfreq = 0;
+  return newfreq;
+}
+
+void LmicIsm2400::handleCFList(const uint8_t *ptr) {
+
+  for (uint8_t chidx = 3; chidx < 8; chidx++, ptr += 3) {
+    uint32_t newfreq = convFreq(ptr);
+    if (newfreq != 0) {
+      setupChannel(chidx, newfreq, 0);
+
+      PRINT_DEBUG(2, F("Setup channel, idx=%d, freq=%" PRIu32 ""), chidx,
+                  newfreq);
+    }
+  }
+}
+
+bool LmicIsm2400::validMapChannels(uint8_t const chMaskCntl,
+                                   uint16_t const chMask) {
+  // Bad page
+  if (chMaskCntl != 0 && chMaskCntl != 6)
+    return false;
+
+  //  disable all channel
+  if (chMaskCntl == 0 && chMask == 0)
+    return false;
+
+  return true;
+}
+
+void LmicIsm2400::mapChannels(uint8_t const chMaskCntl,
+                              uint16_t const chMask) {
+  // ChMaskCntl=6 => All channels ON
+  if (chMaskCntl == 6) {
+    channels.enableAll();
+    return;
+  }
+
+  for (uint8_t chnl = 0; chnl < MAX_CHANNELS; chnl++) {
+    if ((chMask & (1 << chnl)) != 0) {
+      channels.enable(chnl);
+    } else {
+      channels.disable(chnl);
+    }
+  }
+}
+
+uint32_t LmicIsm2400::getTxFrequency() const {
+  return channels.getFrequency(txChnl);
+}
+
+int8_t LmicIsm2400::getTxPower() const {
+  // limit power to value ask in adr (at init MaxEIRP)
+  return adrTxPow;
+};
+
+void LmicIsm2400::updateTxTimes(OsDeltaTime const airtime) {
+  channels.updateAvailabitility(txChnl, os_getTime(), airtime);
+
+  PRINT_DEBUG(
+      2, F("Updating info for TX channel %d, airtime will be %" PRIu32 "."),
+      txChnl, airtime);
+}
+
+OsTime LmicIsm2400::nextTx(OsTime const now) {
+  // no duty cycle, all channels are available at the same time:
+  // next enabled channel or other (random).
+  uint8_t nextChannel = txChnl + 1 + (rand.uint8() % 2);
+
+  for (uint8_t channelIndex = 0; channelIndex < MAX_CHANNELS; channelIndex++) {
+    if (nextChannel >= MAX_CHANNELS) {
+      nextChannel = 0;
+    }
+
+    if (channels.is_enable_at_dr(nextChannel, datarate)) {
+      txChnl = nextChannel;
+      auto const availability = channels.getAvailability(nextChannel);
+      return availability < now ? now : availability;
+    }
+    nextChannel++;
+  }
+
+  // Fail to find a channel continue on current one.
+  PRINT_DEBUG(1, F("Error Fail to find a channel."));
+  return now;
+}
+
+FrequencyAndRate LmicIsm2400::getRx1Parameter() const {
+  // RX1 frequency is same as TX frequency
+  return {getTxFrequency(), lowerDR(datarate, rx1DrOffset)};
+}
+
+void LmicIsm2400::initJoinLoop() {
+  txChnl = rand.uint8() % 3;
+  adrTxPow = MaxEIRP;
+  setDrJoin(static_cast<dr_t>(Dr::SF7));
+  txend = channels.getAvailability(0) + OsDeltaTime::rnd_delay(rand, 8);
+  PRINT_DEBUG(1, F("Init Join loop : avail=%" PRIu32 " txend=%" PRIu32 ""),
+              channels.getAvailability(0).tick(), txend.tick());
+}
+
+bool LmicIsm2400::nextJoinState() {
+  bool failed = false;
+
+  // Try the tree default channels with same DR
+  // If both fail try next lower datarate
+  if (++txChnl == 3)
+    txChnl = 0;
+  if ((++txCnt & 1) == 0) {
+    // Lower DR every 2nd try
+    if (datarate == static_cast<dr_t>(Dr::SF12)) {
+      // we have tried all DR - signal EV_JOIN_FAILED
+      failed = true;
+      // and retry from highest datarate.
+      datarate = static_cast<dr_t>(Dr::SF7);
+    } else
+      datarate = decDR(datarate);
+  }
+
+  // Set minimal next join time
+  auto time = os_getTime();
+  auto availability = channels.getAvailability(txChnl);
+  if (time < availability)
+    time = availability;
+
+  txend = time;
+
+  if (failed)
+    PRINT_DEBUG(2, F("Join failed"));
+  else
+    PRINT_DEBUG(2, F("Scheduling next join at %" PRIu32 ""), txend);
+
+  // 1 - triggers EV_JOIN_FAILED event
+  return !failed;
+}
+
+FrequencyAndRate LmicIsm2400::defaultRX2Parameter() const {
+  return {FREQ_DNW2, static_cast<dr_t>(DR_DNW2)};
+}
+
+#if defined(ENABLE_SAVE_RESTORE)
+void LmicIsm2400::saveStateWithoutTimeData(StoringAbtract &store) const {
+  Lmic::saveStateWithoutTimeData(store);
+
+  channels.saveStateWithoutTimeData(store);
+  store.write(txChnl);
+}
+
+void LmicIsm2400::saveState(StoringAbtract &store) const {
+  Lmic::saveState(store);
+  channels.saveState(store);
+  store.write(txChnl);
+}
+
+void LmicIsm2400::loadStateWithoutTimeData(RetrieveAbtract &store) {
+  Lmic::loadStateWithoutTimeData(store);
+
+  channels.loadStateWithoutTimeData(store);
+  store.read(txChnl);
+}
+
+void LmicIsm2400::loadState(RetrieveAbtract &store) {
+  Lmic::loadState(store);
+
+  channels.loadState(store);
+  store.read(txChnl);
+}
+#endif
+
+LmicIsm2400::LmicIsm2400(LmicRadio &aradio, OsScheduler &ascheduler)
+    : Lmic(aradio, ascheduler) {}
@@ -0,0 +1,74 @@
+/*******************************************************************************
+ * Copyright (c) 2014-2015 IBM Corporation.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors:
+ *    IBM Zurich Research Lab - initial API, implementation and documentation
+ *    Nicolas Graziano - cpp style.
+ *******************************************************************************/
+
+#ifndef _lmic_ism2400_h_
+#define _lmic_ism2400_h_
+
+#include "band.ism2400.h"
+#include "bufferpack.h"
+#include "channelList.h"
+#include "lmic.h"
+
+/**
+ * Worldwide 2.4GHz ISM band (LoRa 812kHz, need a SX1280).
+ */
+class LmicIsm2400 final : public Lmic {
+public:
+  // Max supported channels
+  static const uint8_t MAX_CHANNELS = 16;
+
+  // SF6 and SF5 (DR6, DR7) are not supported.
+  enum class Dr : dr_t { SF12 = 0, SF11, SF10, SF9, SF8, SF7, NONE };
+
+  explicit LmicIsm2400(LmicRadio &radio, OsScheduler &scheduler);
+
+#if defined(ENABLE_SAVE_RESTORE)
+  virtual void saveState(StoringAbtract &store) const final;
+  virtual void saveStateWithoutTimeData(StoringAbtract &store) const final;
+  virtual void loadState(RetrieveAbtract &store) final;
+  virtual void loadStateWithoutTimeData(RetrieveAbtract &store) final;
+#endif
+
+  bool setupChannel(uint8_t channel, uint32_t newfreq, uint16_t drmap) final;
+
+protected:
+  uint32_t getTxFrequency() const final;
+  int8_t getTxPower() const final;
+  FrequencyAndRate getRx1Parameter() const final;
+
+  uint8_t getRawRps(dr_t dr) const final;
+  int8_t pow2dBm(uint8_t powerIndex) const final;
+  OsDeltaTime getDwn2SafetyZone() const final;
+  OsDeltaTime dr2hsym(dr_t dr) const final;
+  uint32_t convFreq(const uint8_t *ptr) const final;
+  bool validRx1DrOffset(uint8_t drOffset) const final;
+
+  void initDefaultChannels() final;
+
+  void disableChannel(uint8_t channel) final;
+  void handleCFList(const uint8_t *ptr) final;
+
+  bool validMapChannels(uint8_t chpage, uint16_t chmap) final;
+  void mapChannels(uint8_t chpage, uint16_t chmap) final;
+  void updateTxTimes(OsDeltaTime airtime) final;
+  OsTime nextTx(OsTime now) final;
+  void initJoinLoop() final;
+  bool nextJoinState() final;
+  FrequencyAndRate defaultRX2Parameter() const final;
+
+private:
+  ChannelList<MAX_CHANNELS, BandsIsm2400> channels;
+  // channel for next TX
+  uint8_t txChnl = 0;
+};
+
+#endif
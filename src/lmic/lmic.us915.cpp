@@ -100,7 +100,12 @@ CONST_TABLE(uint8_t, _DR2RPS_CRC)
       rps_DR11,    rps_DR12,    rps_DR13,    ILLEGAL_RPS};
 
 uint8_t LmicUs915::getRawRps(dr_t dr) const {
-  return TABLE_GET_U1(_DR2RPS_CRC, dr + 1);
+  // dr - 1 (255) wrap to the first element.
+  auto const index = static_cast<uint8_t>(dr + 1);
+  if (index >= sizeof(RESOLVE_TABLE(_DR2RPS_CRC))) {
+    return ILLEGAL_RPS;
+  }
+  return TABLE_GET_U1(_DR2RPS_CRC, index);
 }
 
 int8_t LmicUs915::pow2dBm(uint8_t powerIndex) const {
@@ -132,8 +137,12 @@ static CONST_TABLE(int32_t, DR2HSYM)[] = {
     OsDeltaTime::from_us_round(128 << 0).tick()  // ------    DR_SF7CR
 };
 
-// map DR_SFnCR -> 0-6
+// map DR_SFnCR -> 0-5
 OsDeltaTime LmicUs915::dr2hsym(dr_t dr) const {
+  // out of table, not a RX data rate.
+  if ((dr & 7) >= sizeof(RESOLVE_TABLE(DR2HSYM)) / sizeof(int32_t)) {
+    return OsDeltaTime(0);
+  }
   return OsDeltaTime(TABLE_GET_S4(DR2HSYM, dr & 7));
 }
 
@@ -335,5 +344,5 @@ FrequencyAndRate LmicUs915::defaultRX2Parameter() const {
   return {FREQ_DNW2, static_cast<dr_t>(DR_DNW2)};
 }
 
-LmicUs915::LmicUs915(Radio &aradio, OsScheduler &ascheduler)
+LmicUs915::LmicUs915(LmicRadio &aradio, OsScheduler &ascheduler)
     : Lmic(aradio, ascheduler) {}
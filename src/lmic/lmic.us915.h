@@ -21,7 +21,7 @@ enum {
 
 class LmicUs915 final : public Lmic {
 public:
-  explicit LmicUs915(Radio &radio, OsScheduler &scheduler);
+  explicit LmicUs915(LmicRadio &radio, OsScheduler &scheduler);
 
   bool setupChannel(uint8_t channel, uint32_t newfreq, uint16_t drmap) final;
   void selectSubBand(uint8_t band);
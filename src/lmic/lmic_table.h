@@ -13,7 +13,9 @@
 #ifndef _lmic_table_h_
 #define _lmic_table_h_
 
+#ifdef ARDUINO
 #include "Arduino.h"
+#endif
 #include <stdint.h>
 
 // ======================================================================
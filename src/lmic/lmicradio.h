@@ -0,0 +1,21 @@
+/*******************************************************************************
+ * Radio driver type used by the MAC.
+ *******************************************************************************/
+
+#ifndef _lmicradio_h_
+#define _lmicradio_h_
+
+#include "radio.h"
+
+#if defined(LMIC_STATIC_RADIO)
+#include "radio_sx1262.h"
+#include "radio_sx1272.h"
+#include "radio_sx1276.h"
+#include "radio_sx1280.h"
+// radio driver known at compile time, its functions are called directly.
+using LmicRadio = LMIC_STATIC_RADIO;
+#else
+using LmicRadio = Radio;
+#endif
+
+#endif
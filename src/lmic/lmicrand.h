@@ -13,6 +13,7 @@
 #ifndef _lmicrand_h_
 #define _lmicrand_h_
 
+#include "bufferpack.h"
 #include <stdint.h>
 
 class Radio;
@@ -26,6 +27,10 @@ public:
   void init(Radio &){};
   uint8_t uint8();
   uint16_t uint16();
+#if defined(ENABLE_SAVE_RESTORE)
+  void saveState(StoringAbtract &) const {};
+  void loadState(RetrieveAbtract &){};
+#endif
 };
 
 #else
@@ -33,15 +38,27 @@ public:
 class LmicRand {
 public:
   explicit LmicRand(Aes &aes);
+  /**
+   * Seed the generator with the radio noise (radio must be idle).
+   * Called once by Lmic init, never on the TX path (skipped if the state
+   * restored by loadState() is the seed).
+   */
   void init(Radio &radio);
   uint8_t uint8();
   uint16_t uint16();
+#if defined(ENABLE_SAVE_RESTORE)
+  void saveState(StoringAbtract &store) const;
+  void loadState(RetrieveAbtract &store);
+#endif
 
 private:
+  void mixTime();
+
   Aes &aes;
-  // (initialized by init() with radio RSSI, used by rand1())
-  uint8_t index;
-  uint8_t randbuf[16];
+  // next byte of randbuf to use, encrypt the buffer when above 15.
+  uint8_t index = 16;
+  // (initialized by init() with radio RSSI, used by uint8())
+  uint8_t randbuf[16] = {};
 };
 #endif
 
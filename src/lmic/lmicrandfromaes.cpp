@@ -13,17 +13,28 @@
 #ifndef ARDUINO_ARCH_ESP32
 
 #include "lmicrand.h"
-#include "radio.h"
+#include "lmicradio.h"
+#include "oslmic.h"
 #include "../aes/lmic_aes.h"
 
 LmicRand::LmicRand(Aes &anaes) : aes(anaes) {}
 
+// collect radio noise, AES whitening is done by uint8().
 void LmicRand::init(Radio &radio) {
-  radio.init_random(randbuf);
+  static_cast<LmicRadio &>(radio).init_random(randbuf);
+  mixTime();
   // set initial index to encrypt at next
   index = 16;
 }
 
+// boot time jitter, low entropy but free.
+void LmicRand::mixTime() {
+  uint32_t const now = os_getTime().tick();
+  for (uint8_t i = 0; i < 4; i++) {
+    randbuf[i] ^= static_cast<uint8_t>(now >> (8 * i));
+  }
+}
+
 // return next random byte derived from seed buffer
 uint8_t LmicRand::uint8() {
   if (index > 15) {
@@ -37,4 +48,24 @@ uint8_t LmicRand::uint8() {
 //! Get random number (default impl for uint16_t).
 uint16_t LmicRand::uint16() { return ((uint16_t)((uint8() << 8U) | uint8())); }
 
+#if defined(ENABLE_SAVE_RESTORE)
+void LmicRand::saveState(StoringAbtract &store) const {
+  for (auto const val : randbuf) {
+    store.write(val);
+  }
+}
+
+// A restored state is mixed with the radio seed of this boot.
+void LmicRand::loadState(RetrieveAbtract &store) {
+  uint8_t saved[16];
+  store.read(saved);
+  for (uint8_t i = 0; i < 16; i++) {
+    randbuf[i] ^= saved[i];
+  }
+  // avoid same sequence if the same state is loaded twice.
+  mixTime();
+  index = 16;
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -17,7 +17,8 @@
 
 enum class CodingRate : uint8_t { CR_4_5 = 0, CR_4_6, CR_4_7, CR_4_8 };
 enum _sf_t { FSK = 0, SF7, SF8, SF9, SF10, SF11, SF12, SFrfu };
-enum class BandWidth { BW125 = 0, BW250, BW500 };
+// BW800 is the 812.5kHz bandwidth of the 2.4GHz band (SX1280 only)
+enum class BandWidth { BW125 = 0, BW250, BW500, BW800 };
 
 typedef uint8_t sf_t;
 typedef uint8_t dr_t;
@@ -51,6 +52,8 @@ constexpr uint8_t ILLEGAL_RPS = 0xFF;
 // Global maximum frame length
 constexpr uint8_t STD_PREAMBLE_LEN = 8;
 constexpr uint8_t MAX_LEN_FRAME = 64;
+// raw LoRa frame (peer to peer link)
+constexpr uint8_t MAX_LEN_RAW_FRAME = 255;
 constexpr uint8_t DELAY_JACC1 = 5;   // in secs
 constexpr uint8_t DELAY_DNW1 = 1;    // in secs down window #1
 constexpr uint8_t DELAY_EXTDNW2 = 1; // in secs
@@ -0,0 +1,90 @@
+/*******************************************************************************
+ * Raw LoRa peer to peer link.
+ *******************************************************************************/
+
+#include "lorap2p.h"
+#include "../hal/print_debug.h"
+
+#include <string.h>
+
+LoraP2p::LoraP2p(LmicRadio &aradio, OsScheduler &ascheduler)
+    : radio(aradio), osjob(*this, ascheduler) {}
+
+void LoraP2p::start(uint32_t const freq, RawLoraConfig const &aconfig,
+                    int8_t const txpow) {
+  frequency = freq;
+  config = aconfig;
+  txPower = txpow;
+  next_operation();
+}
+
+void LoraP2p::stop() {
+  state = State::STOPPED;
+  osjob.clearCallback();
+  radio.rst();
+}
+
+bool LoraP2p::send(uint8_t const *const data, uint8_t const length) {
+  if (length == 0 || queueFree() < length + 1) {
+    return false;
+  }
+  queue[queueLength] = length;
+  memcpy(queue + queueLength + 1, data, length);
+  queueLength += length + 1;
+  // interrupt RX, a frame being received is lost.
+  if (state == State::RX) {
+    next_operation();
+  }
+  return true;
+}
+
+uint16_t LoraP2p::queueFree() const {
+  return LMIC_P2P_QUEUE_SIZE - queueLength;
+}
+
+void LoraP2p::setRxCallback(rxCallback_t const callback) {
+  rxCallback = callback;
+}
+
+// send first queued frame or listen.
+void LoraP2p::next_operation() {
+  if (queueLength > 0) {
+    state = State::TX;
+    radio.tx_raw(frequency, config, txPower, queue + 1, queue[0]);
+    osjob.setCallbackRunnable(&LoraP2p::wait_end_tx);
+  } else {
+    state = State::RX;
+    radio.rx_raw(frequency, config);
+    osjob.setCallbackRunnable(&LoraP2p::wait_end_rx);
+  }
+}
+
+void LoraP2p::wait_end_rx() {
+  if (radio.io_check()) {
+    // radio is still in RX, the next frame can already come.
+    uint8_t const length = radio.read_raw(frame);
+    if (length > 0 && rxCallback) {
+      rxCallback(frame, length);
+    }
+  }
+  if (state == State::RX) {
+    osjob.setCallbackRunnable(&LoraP2p::wait_end_rx);
+  }
+}
+
+void LoraP2p::wait_end_tx() {
+  if (!radio.io_check()) {
+    // if radio has not finish come back later (loop).
+    osjob.setCallbackRunnable(&LoraP2p::wait_end_tx);
+    return;
+  }
+  // next operation starts now.
+  radio.handle_end_tx(OsDeltaTime(0));
+  PRINT_DEBUG(1, F("End TX raw, %d bytes"), queue[0]);
+
+  // remove sent frame.
+  uint16_t const sent = queue[0] + 1;
+  queueLength -= sent;
+  memmove(queue, queue + sent, queueLength);
+  next_operation();
+}
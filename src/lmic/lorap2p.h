@@ -0,0 +1,58 @@
+/*******************************************************************************
+ * Raw LoRa peer to peer link.
+ *
+ * No MAC: frames are sent as soon as they are queued and the radio listen
+ * continuously between them. Both ends must use the same RawLoraConfig.
+ *******************************************************************************/
+
+#ifndef _lorap2p_h_
+#define _lorap2p_h_
+
+#include "lmic.h"
+#include "lorabase.h"
+#include "oslmic.h"
+#include "radio.h"
+#include <stdint.h>
+
+class LoraP2p {
+public:
+  using rxCallback_t = void (*)(uint8_t const *data, uint8_t length);
+
+  explicit LoraP2p(LmicRadio &radio, OsScheduler &scheduler);
+
+  /**
+   * Start continuous RX, queued frames are sent first.
+   */
+  void start(uint32_t freq, RawLoraConfig const &config, int8_t txpow);
+  void stop();
+
+  /**
+   * Queue a frame, it is sent back to back with the previous ones.
+   * Return false if the queue is full.
+   * With an implicit header length must be the configured length.
+   */
+  bool send(uint8_t const *data, uint8_t length);
+  uint16_t queueFree() const;
+  void setRxCallback(rxCallback_t callback);
+
+private:
+  enum class State : uint8_t { STOPPED, RX, TX };
+
+  LmicRadio &radio;
+  OsJobType<LoraP2p> osjob;
+  rxCallback_t rxCallback = nullptr;
+  RawLoraConfig config{};
+  uint32_t frequency = 0;
+  int8_t txPower = 0;
+  State state = State::STOPPED;
+  // frames waiting for TX, each one is stored with its length first.
+  uint16_t queueLength = 0;
+  uint8_t queue[LMIC_P2P_QUEUE_SIZE];
+  uint8_t frame[MAX_LEN_RAW_FRAME];
+
+  void next_operation();
+  void wait_end_rx();
+  void wait_end_tx();
+};
+
+#endif // _lorap2p_h_
@@ -14,7 +14,9 @@
 #define _oslmic_h_
 
 #include "../hal/hal.h"
+#ifdef ARDUINO
 #include "Arduino.h"
+#endif
 #include "config.h"
 #include "osticks.h"
 #include <stdint.h>
@@ -35,9 +37,6 @@ void os_init(void);
 
 //================================================================================
 
-constexpr OsDeltaTime RX_RAMPUP = OsDeltaTime::from_us(40000);
-constexpr OsDeltaTime TX_RAMPUP = OsDeltaTime::from_us(2000);
-
 #ifndef HAS_os_calls
 
 #ifndef os_getTime
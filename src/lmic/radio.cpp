@@ -1,14 +1,117 @@
 #include "radio.h"
+#include "../hal/hal.h"
+#include "../hal/print_debug.h"
+#include "bufferpack.h"
+#include "lmicradio.h"
 
 int16_t Radio::get_last_packet_rssi() const {
-  // see documentation for -139
-  // do not handle snr > 0
-  return -139 + last_packet_rssi_reg;
+  return quality[quality_last].rssi;
 }
 
 int8_t Radio::get_last_packet_snr_x4() const {
-  return last_packet_snr_reg;
+  return quality[quality_last].snr_x4;
 }
 
+// with LMIC_STATIC_RADIO the functions of the driver are not virtual, they
+// are called on LmicRadio (the only driver of the build).
+void Radio::init() {
+  auto &driver = static_cast<LmicRadio &>(*this);
+  OsDeltaTime wait = driver.init_step();
+  while (wait.tick() != 0) {
+    hal_wait(wait);
+    wait = driver.init_step();
+  }
+}
+
+void Radio::tx(uint32_t const freq, rps_t const rps, int8_t const txpow,
+               uint8_t const *const framePtr, uint8_t const frameLength) {
+  auto &driver = static_cast<LmicRadio &>(*this);
+  driver.prepare_tx(freq, rps, txpow, framePtr, frameLength);
+  driver.start_tx();
+}
+
+uint8_t Radio::quality_history_size() const { return quality_count; }
+
+PacketQuality Radio::quality_history(uint8_t const age) const {
+  if (age >= quality_count) {
+    return PacketQuality{0, 0};
+  }
+  uint8_t const index =
+      (quality_last + QUALITY_HISTORY_SIZE - age) % QUALITY_HISTORY_SIZE;
+  return quality[index];
+}
+
+uint32_t Radio::symbol_time_us(rps_t const rps) {
+  // Tsym = 2^SF / BW
+  if (rps.getBw() == BandWidth::BW800) {
+    // 812.5kHz = 13 * 62.5kHz
+    return (UINT32_C(16) << (rps.sf + 6)) / 13;
+  }
+  uint32_t const bw_khz = UINT32_C(125)
+                          << static_cast<uint8_t>(rps.getBw());
+  return (UINT32_C(1000) << (rps.sf + 6)) / bw_khz;
+}
+
+bool Radio::wait_cad_end(rps_t const rps, uint8_t const cad_symbols,
+                         bool (HalIo::*const done)() const) const {
+  // one more symbol for the detection and 2ms to wake up
+  OsTime const deadline =
+      hal_ticks() +
+      OsDeltaTime::from_us(symbol_time_us(rps) * (cad_symbols + 1)) +
+      OsDeltaTime::from_ms(2);
+  while (!(hal.*done)()) {
+    if (hal_ticks() > deadline) {
+      PRINT_DEBUG(1, F("CAD timeout, channel taken as free"));
+      return false;
+    }
+    yield();
+  }
+  return true;
+}
+
+void Radio::store_packet_quality(int16_t const rssi, int8_t const snr_x4) {
+  if (quality_count > 0) {
+    quality_last = (quality_last + 1) % QUALITY_HISTORY_SIZE;
+  }
+  if (quality_count < QUALITY_HISTORY_SIZE) {
+    quality_count++;
+  }
+  quality[quality_last] = PacketQuality{rssi, snr_x4};
+}
+
+// 40ppm, above that an error is more likely than a crystal drift.
+constexpr int32_t MAX_FREQ_ERROR_PPB = 40000;
+
+uint32_t Radio::corrected_frequency(uint32_t const freq) {
+  last_frequency = freq;
+  if (!afc_enabled || freq_error_ppb == 0) {
+    return freq;
+  }
+  return freq + static_cast<int32_t>(static_cast<int64_t>(freq) *
+                                     freq_error_ppb / 1000000000);
+}
+
+void Radio::store_frequency_error(int32_t const error_hz) {
+  if (!afc_enabled || last_frequency == 0) {
+    return;
+  }
+  // measure is done on corrected frequency, only the residual error is
+  // seen: integrate a quarter of it to filter noise of the measure.
+  auto const residual = static_cast<int32_t>(
+      static_cast<int64_t>(error_hz) * 1000000000 / last_frequency);
+  freq_error_ppb = clamp(freq_error_ppb + residual / 4, -MAX_FREQ_ERROR_PPB,
+                         MAX_FREQ_ERROR_PPB);
+  PRINT_DEBUG(2, F("Frequency error %" PRIi32 " Hz, AFC %" PRIi32 " ppb"),
+              error_hz, freq_error_ppb);
+}
+
+void Radio::wait_start(OsTime const time) {
+  ready_time = hal_ticks();
+  hal_waitUntil(time);
+}
+
+OsTime Radio::operation_end_time() const { return hal.edge_time(); }
+
+void Radio::store_trigger() const { hal.store_edge(); }
 
 Radio::Radio(lmic_pinmap const &pins) : hal(pins) {}
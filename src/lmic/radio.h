@@ -18,30 +18,269 @@
 #include "osticks.h"
 #include <stdint.h>
 
+/**
+ * Reception quality of one packet.
+ */
+struct PacketQuality {
+  // RSSI [dBm]
+  int16_t rssi;
+  // SNR [dB] * 4
+  int8_t snr_x4;
+};
+
+/**
+ * Packet counters of the receiver.
+ */
+struct RadioStats {
+  uint16_t received;
+  uint16_t crc_error;
+  uint16_t header_error;
+};
+
+/**
+ * Receiver gain, boosted gain gives about 2dB more sensitivity for a few
+ * mA more.
+ */
+enum class RxGain : uint8_t {
+  BOOSTED,
+  POWER_SAVING,
+};
+
+/**
+ * LoRa settings of a raw peer to peer link.
+ */
+struct RawLoraConfig {
+  rps_t rps;
+  // LoRa sync word (0x12 private networks, 0x34 LoRaWAN)
+  uint8_t sync_word;
+  // preamble length in symbols
+  uint16_t preamble;
+  // implicit header, all frames have this length (0 = explicit header)
+  uint8_t implicit_length;
+  bool invert_iq;
+};
+
+#if defined(LMIC_STATIC_RADIO)
+// driver functions are plain members of LMIC_STATIC_RADIO, no vtable.
+#define RADIO_VIRTUAL
+#define RADIO_PURE
+#define RADIO_FINAL
+#else
+#define RADIO_VIRTUAL virtual
+#define RADIO_PURE = 0
+#define RADIO_FINAL final
+#endif
+
+/**
+ * Radio driver interface.
+ * With LMIC_STATIC_RADIO its functions are not virtual: they are only
+ * declared here and the drivers define them, so Radio must not be used with
+ * another driver than LMIC_STATIC_RADIO.
+ */
 class Radio {
 
 public:
   explicit Radio(lmic_pinmap const &pins);
-  virtual void init(void) = 0;
-  virtual void rst() const = 0;
-  virtual void tx(uint32_t freq, rps_t rps, int8_t txpow,
-                  uint8_t const *framePtr, uint8_t frameLength) = 0;
-  virtual void rx(uint32_t freq, rps_t rps, uint8_t rxsyms, OsTime rxtime) = 0;
+  /**
+   * Reset and configure the radio (blocking, a few ms).
+   */
+  void init();
+  /**
+   * Run init() one step at a time: return the delay to wait before the
+   * next call, zero when the radio is ready.
+   */
+  RADIO_VIRTUAL OsDeltaTime init_step() RADIO_PURE;
+  RADIO_VIRTUAL void rst() RADIO_PURE;
+  /**
+   * Configure radio and load frame, radio is left ready to transmit
+   * (synthesizer running) until start_tx().
+   */
+  RADIO_VIRTUAL void prepare_tx(uint32_t freq, rps_t rps, int8_t txpow,
+                                uint8_t const *framePtr,
+                                uint8_t frameLength) RADIO_PURE;
+  /**
+   * Start transmission prepared by prepare_tx() (only one command).
+   */
+  RADIO_VIRTUAL void start_tx() RADIO_PURE;
+  void tx(uint32_t freq, rps_t rps, int8_t txpow, uint8_t const *framePtr,
+          uint8_t frameLength);
+  RADIO_VIRTUAL void rx(uint32_t freq, rps_t rps, uint8_t rxsyms,
+                        OsTime rxtime) RADIO_PURE;
+  /**
+   * Receiver gain used from next RX (boosted by default), power saving
+   * gain suits long listening (rx_sniff(), rx_raw()).
+   */
+  void set_rx_gain(RxGain gain) { rx_gain = gain; }
+
+  /**
+   * Automatic frequency correction (enabled by default): the frequency
+   * error of each received LoRa packet is filtered and the estimated
+   * crystal error is removed from next TX/RX frequencies.
+   */
+  void set_afc(bool enabled) { afc_enabled = enabled; }
+  /**
+   * Estimated crystal error [ppb], can be saved and restored.
+   */
+  int32_t frequency_error_ppb() const { return freq_error_ppb; }
+  void set_frequency_error_ppb(int32_t ppb) { freq_error_ppb = ppb; }
+
+  /**
+   * Run a channel activity detection (blocking, a few symbols).
+   * Return true if a LoRa preamble is detected.
+   */
+  RADIO_VIRTUAL bool channel_activity(uint32_t freq, rps_t rps) RADIO_PURE;
+
+  /**
+   * Start low power listening: the radio alternates short RX and sleep
+   * periods sized to catch a preamble of preamble_syms symbols, and stays
+   * in RX when one is detected. End of RX is signaled as for rx().
+   */
+  RADIO_VIRTUAL void rx_sniff(uint32_t freq, rps_t rps,
+                              uint16_t preamble_syms) RADIO_PURE;
 
-  virtual void init_random(uint8_t randbuf[16]) = 0;
-  virtual uint8_t handle_end_rx(uint8_t *framePtr) = 0;
-  virtual void handle_end_tx() const = 0;
+  /**
+   * Start a raw LoRa transmission now (up to MAX_LEN_RAW_FRAME bytes).
+   * End is signaled as for start_tx().
+   */
+  RADIO_VIRTUAL void tx_raw(uint32_t freq, RawLoraConfig const &config,
+                            int8_t txpow, uint8_t const *framePtr,
+                            uint8_t frameLength) RADIO_PURE;
+  /**
+   * Start continuous raw LoRa reception, io_check() is true when a frame is
+   * received. The radio stays in RX until another operation or rst().
+   */
+  RADIO_VIRTUAL void rx_raw(uint32_t freq,
+                            RawLoraConfig const &config) RADIO_PURE;
+  /**
+   * Read the frame received in rx_raw() (framePtr must hold
+   * MAX_LEN_RAW_FRAME bytes), RX goes on.
+   * Return its length, 0 if invalid (CRC or header error).
+   */
+  RADIO_VIRTUAL uint8_t read_raw(uint8_t *framePtr) RADIO_PURE;
 
-  virtual uint8_t rssi() const = 0;
+  RADIO_VIRTUAL void init_random(uint8_t randbuf[16]) RADIO_PURE;
+  RADIO_VIRTUAL uint8_t handle_end_rx(uint8_t *framePtr) RADIO_PURE;
+  /**
+   * End of TX, idle is the time until the next radio operation: the radio
+   * may stay in standby if waking it from sleep would cost more.
+   */
+  RADIO_VIRTUAL void handle_end_tx(OsDeltaTime idle) RADIO_PURE;
 
-  virtual bool io_check() const = 0;
+  /**
+   * Current RSSI [dBm] (radio must be in RX).
+   */
+  RADIO_VIRTUAL int16_t rssi() const RADIO_PURE;
+  /**
+   * Packet counters since init.
+   */
+  RADIO_VIRTUAL RadioStats stats() const RADIO_PURE;
+
+  /**
+   * Nominal time needed by rx() before the start of reception
+   * (wake up, calibration, configuration), used until measured by the MAC.
+   */
+  RADIO_VIRTUAL OsDeltaTime rx_rampup() const RADIO_PURE;
+  /**
+   * Nominal duration of prepare_tx().
+   */
+  RADIO_VIRTUAL OsDeltaTime tx_rampup() const RADIO_PURE;
+  /**
+   * Extra setup time of an operation starting at time, when the radio
+   * calibrates before it (cold start, periodic calibration), else 0.
+   * Not included in the rampup measured by the MAC.
+   */
+  RADIO_VIRTUAL OsDeltaTime calibration_rampup(OsTime time) const RADIO_PURE;
+  /**
+   * Start the calibration due before an operation at time and return at
+   * once: the chip is busy during calibration_rampup(), the next command
+   * waits for its end.
+   */
+  RADIO_VIRTUAL void start_calibration(OsTime time) RADIO_PURE;
+  /**
+   * Time the radio was configured in last rx(), before waiting rxtime.
+   */
+  OsTime last_ready_time() const { return ready_time; }
+
+  RADIO_VIRTUAL bool io_check() const RADIO_PURE;
   int16_t get_last_packet_rssi() const;
   int8_t get_last_packet_snr_x4() const;
 
+  static constexpr uint8_t QUALITY_HISTORY_SIZE = 4;
+  /**
+   * Number of packets in quality history (up to QUALITY_HISTORY_SIZE).
+   */
+  uint8_t quality_history_size() const;
+  /**
+   * Quality of a received packet, age 0 is the last one.
+   */
+  PacketQuality quality_history(uint8_t age) const;
+
+  /**
+   * Time of the end of last tx/rx (DIO edge if captured, else now).
+   */
+  OsTime operation_end_time() const;
+  /**
+   * Store time of DIO change, for pin without interrupt capture in HAL
+   * (call it from a pin change interrupt).
+   */
+  void store_trigger() const;
+
 protected:
-  int8_t last_packet_snr_reg = 0;
-  uint8_t last_packet_rssi_reg = 0;
+  /**
+   * Duration of one LoRa symbol in us.
+   */
+  static uint32_t symbol_time_us(rps_t rps);
+
+  /**
+   * Symbols from end of RX window to end of LoRa header
+   * (preamble 8, sync word 4.25, header 8 symbols).
+   */
+  static constexpr uint8_t HEADER_END_SYMBOLS = 21;
+
+  /**
+   * Wait the end of a CAD of cad_symbols started now, signaled by the DIO
+   * read by done. Return false if it does not come in time, a miswired pin
+   * or a stuck chip must not hang the node.
+   */
+  bool wait_cad_end(rps_t rps, uint8_t cad_symbols,
+                    bool (HalIo::*done)() const) const;
+
+  /**
+   * Store quality of received packet (called by driver in handle_end_rx).
+   */
+  void store_packet_quality(int16_t rssi, int8_t snr_x4);
+
+  /**
+   * Frequency to set in the radio for the wanted one (AFC applied).
+   */
+  uint32_t corrected_frequency(uint32_t freq);
+  /**
+   * Update AFC with frequency error of a received packet [Hz], signal
+   * frequency minus radio frequency.
+   */
+  void store_frequency_error(int32_t error_hz);
+
+  /**
+   * Wait start time of operation, store time radio is ready.
+   */
+  void wait_start(OsTime time);
+
   HalIo hal;
+  RxGain rx_gain = RxGain::BOOSTED;
+
+  // steps of init_step(): reset pin driven, then released.
+  enum class InitState : uint8_t { START, RESET, BOOT };
+  InitState init_state = InitState::START;
+
+private:
+  PacketQuality quality[QUALITY_HISTORY_SIZE] = {};
+  uint8_t quality_last = 0;
+  uint8_t quality_count = 0;
+  OsTime ready_time;
+  bool afc_enabled = true;
+  int32_t freq_error_ppb = 0;
+  // wanted frequency of last operation (AFC measure)
+  uint32_t last_frequency = 0;
 };
 
 #endif
\ No newline at end of file
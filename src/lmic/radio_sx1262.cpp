@@ -7,6 +7,7 @@
 
 #include "../aes/lmic_aes.h"
 #include "lmic_table.h"
+#include "radio_sx12xx_cmd.h"
 
 #include "bufferpack.h"
 
@@ -59,123 +60,37 @@ enum RadioCommand : uint8_t {
 
 };
 
-void wait_ready(HalIo const &hal) {
-  // wait for busy pin to go low
-  while (hal.io_check0()) {
-    yield();
-  }
-}
-
 void print_status(uint8_t status) {
   PRINT_DEBUG(1, F("Status %x mode : %x, status %x"), status, (status >> 4) & 7,
               (status >> 1) & 7);
 }
 
-template <int parameter_length> struct Sx1262Command {
-  RadioCommand const command;
-  uint8_t parameter[parameter_length];
-
-  uint8_t *begin() { return parameter; }
-  uint8_t *end() { return parameter + parameter_length; }
-
-  constexpr uint8_t const *begin() const { return parameter; }
-  constexpr uint8_t const *end() const { return parameter + parameter_length; }
-};
-
-template <> struct Sx1262Command<0> { RadioCommand const command; };
-
-void send_command(HalIo const &hal, RadioCommand cmd,
-                  uint8_t const *begin_parameter,
-                  uint8_t const *end_parameter) {
-  PRINT_DEBUG(2, F("Cmd> %x"), cmd);
-  hal.beginspi();
-  wait_ready(hal);
-  hal.spi(cmd);
-
-  std::for_each(begin_parameter, end_parameter,
-                [&hal](uint8_t const val) { hal.spi(val); });
-
-  hal.endspi();
-}
-
 template <int parameter_length>
-void send_command(HalIo const &hal,
-                  Sx1262Command<parameter_length> const &cmd) {
-  send_command(hal, cmd.command, cmd.begin(), cmd.end());
-}
-
-template <>
-void send_command<0>(HalIo const &hal, Sx1262Command<0> const &cmd) {
-  PRINT_DEBUG(2, F("Cmd> %x"), cmd);
-  hal.beginspi();
-  wait_ready(hal);
-  hal.spi(cmd.command);
-  hal.endspi();
-}
-
-void read_command(HalIo const &hal, RadioCommand cmd, uint8_t *begin_parameter,
-                  uint8_t *end_parameter) {
-  PRINT_DEBUG(2, F("Cmd< %x"), cmd);
-
-  hal.beginspi();
-  wait_ready(hal);
-  hal.spi(cmd);
-  hal.spi(0x00);
-
-  std::generate(begin_parameter, end_parameter,
-                [&hal]() { return hal.spi(0x00); });
-
-  hal.endspi();
-}
-
-template <int parameter_length>
-void read_command(HalIo const &hal, Sx1262Command<parameter_length> &cmd) {
-  read_command(hal, cmd.command, cmd.begin(), cmd.end());
-}
-
-template <int data_length> struct Sx1262Register {
-  uint16_t const address;
-  uint8_t data[data_length];
-
-  uint8_t *begin() { return data; }
-  uint8_t *end() { return data + data_length; }
-
-  uint8_t const *begin() const { return data; }
-  uint8_t const *end() const { return data + data_length; }
-};
-
+using Sx1262Command = sx12xx::Command<RadioCommand, parameter_length>;
+template <int length>
+using Sx1262Command_P = sx12xx::Command_P<RadioCommand, length>;
 template <int data_length>
-void read_register(HalIo const &hal, Sx1262Register<data_length> &reg) {
-  PRINT_DEBUG(2, F("Reg< %x"), reg.address);
+using Sx1262Register = sx12xx::Register<RadioCommand, data_length>;
 
-  hal.beginspi();
-  wait_ready(hal);
-  hal.spi(RadioCommand::ReadRegister);
-  // send adress
-  hal.spi(static_cast<uint8_t>(reg.address >> 8));
-  hal.spi(static_cast<uint8_t>(reg.address & 0xff));
-  // send initial NOP
-  hal.spi(0x00);
+using sx12xx::command_changed;
+using sx12xx::read_command;
+using sx12xx::read_register;
+using sx12xx::send_command;
+using sx12xx::wait_ready;
 
-  // read data
-  std::generate(reg.begin(), reg.end(), [&hal]() { return hal.spi(0x00); });
-
-  hal.endspi();
+void write_register(HalIo const &hal, uint16_t const address,
+                    uint8_t const *const data, uint8_t const length) {
+  sx12xx::write_register<RadioCommand>(hal, address, data, length);
 }
 
 template <int data_length>
 void write_register(HalIo const &hal, Sx1262Register<data_length> const &reg) {
-  PRINT_DEBUG(2, F("Reg> %x"), reg.address);
+  sx12xx::write_register(hal, reg);
+}
 
-  hal.beginspi();
-  wait_ready(hal);
-  hal.spi(RadioCommand::WriteRegister);
-  // send adress
-  hal.spi(static_cast<uint8_t>(reg.address >> 8));
-  hal.spi(static_cast<uint8_t>(reg.address & 0xff));
-  // Write data
-  std::for_each(reg.begin(), reg.end(), [&hal](uint8_t val) { hal.spi(val); });
-  hal.endspi();
+// frequency in PLL steps (32MHz / 2^25)
+uint32_t rf_frequency_steps(uint32_t const freq) {
+  return (((uint64_t)freq << 25) / 32000000);
 }
 
 constexpr uint8_t sf_to_parameter(sf_t sf) {
@@ -207,30 +122,65 @@ uint16_t bwForLog(rps_t const rps) {
   return TABLE_GET_U2(BW_ENUM_TO_VAL, index);
 }
 
+// temperature change slowly, calibrate again after this time.
+constexpr OsDeltaTime CALIBRATION_INTERVAL = OsDeltaTime::from_sec(3600);
+// image calibration and calibration of all blocks (3.5ms in datasheet).
+constexpr OsDeltaTime CALIBRATION_TIME = OsDeltaTime::from_ms(5);
+
 CONST_TABLE(uint16_t, CALIBRATION_CMD)
 [] = {
     0x6B6F, 0x7581, 0xC1C5, 0xD7DB, 0xE1E9,
 };
 
-template <int length> struct Sx1262Command_P {
-  Sx1262Command<length> item;
-  constexpr Sx1262Command_P(Sx1262Command<length> const &it) : item(it) {}
+// Optimal PA settings (datasheet table 13-21), the first one able to give
+// the power is used: the smaller PA draw less current at low power.
+// {max power dBm, paDutyCycle, hpMax}, power is reduced from +22 setting.
+CONST_TABLE(uint8_t, PA_CONFIG)[][3] = {
+    {14, 0x02, 0x02},
+    {17, 0x02, 0x03},
+    {20, 0x03, 0x05},
+    {22, 0x04, 0x07},
 };
 
-template <int length>
-void send_command(HalIo const &hal, Sx1262Command_P<length> const &cmd_P) {
-  Sx1262Command<length> cmd{RadioCommand::ResetStats, {}};
-  memcpy_P(&cmd, &cmd_P.item, sizeof(cmd));
-  send_command(hal, cmd);
-}
+constexpr uint8_t NB_PA_CONFIG =
+    sizeof(RESOLVE_TABLE(PA_CONFIG)) / sizeof(RESOLVE_TABLE(PA_CONFIG)[0]);
 
-template <>
-void send_command<0>(HalIo const &hal, Sx1262Command_P<0> const &cmd_P) {
-  Sx1262Command<0> cmd{RadioCommand::ResetStats};
-  memcpy_P(&cmd, &cmd_P.item, sizeof(cmd));
-  send_command(hal, cmd);
+// CAD detection peak by spreading factor (SF7 to SF12), from AN1200.48
+CONST_TABLE(uint8_t, CAD_DET_PEAK)[] = {22, 22, 23, 24, 25, 28};
+constexpr uint8_t CAD_DET_MIN = 10;
+
+// CAD length, 2^n symbols: 2 (SF7-SF8), 4 (SF9-SF11) 8 (SF12)
+constexpr uint8_t cad_symbol_num(sf_t const sf) {
+  return sf <= SF8 ? 0x01 : sf <= SF11 ? 0x02 : 0x03;
 }
 
+// LoRa sync word register, LoRaWAN value
+constexpr uint16_t REG_LORA_SYNC_WORD = 0x0740;
+constexpr uint8_t LORA_MAC_SYNC_WORD = 0x34;
+
+// RX gain register, kept in warm start sleep with the retention list
+// (number of registers and their addresses).
+constexpr uint16_t REG_RX_GAIN = 0x08AC;
+constexpr uint8_t RX_GAIN_BOOSTED = 0x96;
+constexpr uint8_t RX_GAIN_POWER_SAVING = 0x94;
+constexpr uint16_t REG_RETENTION_LIST = 0x029F;
+
+// frequency error of last LoRa packet (20 bits signed)
+constexpr uint16_t REG_FREQ_ERROR = 0x076B;
+
+// time to wake up from warm sleep and lock PLL before listening (us)
+constexpr uint32_t SNIFF_WAKEUP_US = 1000;
+// listen at least this number of symbols to detect a preamble
+constexpr uint8_t SNIFF_RX_SYMBOLS = 2;
+
+/**
+ * Set packet type
+ * GFSK = 0x00
+ * LORA = 0x01
+ */
+constexpr uint8_t PACKET_TYPE_GFSK = 0x00;
+constexpr uint8_t PACKET_TYPE_LORA = 0x01;
+
 namespace cmds {
 // Commands with parameters.
 struct SetLoraSymbNumCommand : Sx1262Command<1> {
@@ -241,18 +191,19 @@ struct SetLoraSymbNumCommand : Sx1262Command<1> {
 
 // Fixed value commands
 
-/**
- * Command to start RX (timeout define in char elsewhere)
- */
-constexpr Sx1262Command_P<3> set_rx PROGMEM =
-    Sx1262Command<3>{RadioCommand::SetRx, {0x00, 0x00, 0x00}};
-
 /**
  * Command to start RX (no timeout)
  */
 constexpr Sx1262Command_P<3> set_rx_continious PROGMEM =
     Sx1262Command<3>{RadioCommand::SetRx, {0xFF, 0xFF, 0xFF}};
 
+/**
+ * RX timer stop on sync word / header detection (not on preamble), a false
+ * preamble detection doesn't keep the receiver on.
+ */
+constexpr Sx1262Command_P<1> stop_timer_on_header PROGMEM =
+    Sx1262Command<1>{RadioCommand::StopTimerOnPreamble, {0x00}};
+
 /**
  * Command to change to FS mode
  */
@@ -290,18 +241,47 @@ constexpr Sx1262Command_P<1> clear_device_errors PROGMEM =
 constexpr Sx1262Command_P<4> set_DIO3_as_tcxo_ctrl PROGMEM =
     Sx1262Command<4>{RadioCommand::SetDIO3AsTcxoCtrl, {0x02, 0x00, 0x01, 0x40}};
 
-constexpr auto set_sync_word_lora = Sx1262Register<2>{0x740, {0x34, 0x44}};
+/**
+ * LoRaWAN FSK sync word C194C1 and whitening seed (same as SX127x).
+ * CRC initial value (0x1D0F) and polynomial (0x1021) are reset values.
+ */
+constexpr auto set_sync_word_fsk =
+    Sx1262Register<3>{0x6C0, {0xC1, 0x94, 0xC1}};
+constexpr auto set_whitening_seed_fsk =
+    Sx1262Register<2>{0x6B8, {0x01, 0xFF}};
 
 /**
- * Set paquet type
- * LORA = 0x01
+ * LoRaWAN FSK modulation.
+ * Bitrate 50kbps => 32 * 32MHz / 50000 = 0x005000
+ * Gaussian BT 0.5 => 0x09
+ * RX bandwidth 117.3kHz => 0x0B
+ * Deviation 25kHz => 25000 * 2^25 / 32MHz = 0x006666
+ */
+constexpr Sx1262Command_P<8> set_modulation_params_fsk PROGMEM =
+    Sx1262Command<8>{RadioCommand::SetModulationParams,
+                     {0x00, 0x50, 0x00, 0x09, 0x0B, 0x00, 0x66, 0x66}};
+
+/**
+ * Command to start channel activity detection
  */
-constexpr Sx1262Command_P<1> set_packet_type_lora PROGMEM =
-    Sx1262Command<1>{RadioCommand::SetPacketType, {0x01}};
+constexpr Sx1262Command_P<0> set_cad PROGMEM =
+    Sx1262Command<0>{RadioCommand::SetCad};
 
 constexpr Sx1262Command_P<1> set_sleep_cold_start PROGMEM =
     Sx1262Command<1>{RadioCommand::SetSleep, {0x00}};
 
+/**
+ * Standby with oscillator on after TX and RX (TCXO kept running).
+ */
+constexpr Sx1262Command_P<1> set_fallback_stdby_xosc PROGMEM =
+    Sx1262Command<1>{RadioCommand::SetRxTxFallbackMode, {0x30}};
+
+/**
+ * Sleep with configuration retention
+ */
+constexpr Sx1262Command_P<1> set_sleep_warm_start PROGMEM =
+    Sx1262Command<1>{RadioCommand::SetSleep, {0x04}};
+
 constexpr Sx1262Command_P<2> clear_all_irq PROGMEM =
     Sx1262Command<2>{RadioCommand::ClearIrqStatus, {0x03, 0xFF}};
 
@@ -309,19 +289,32 @@ constexpr Sx1262Command_P<2> clear_all_irq PROGMEM =
 
 } // namespace
 
-void RadioSx1262::init() {
-  PRINT_DEBUG(1, F("Radio Init"));
-  hal.init();
-  // manually reset radio
-  // drive RST pin low
-  hal.pin_rst(0);
-  // wait >100us for SX1262 to detect reset
-  hal_wait(OsDeltaTime::from_ms(1));
-  // configure RST pin floating
-  hal.pin_rst(2);
-  // wait 5ms after reset
-  hal_wait(OsDeltaTime::from_ms(5));
-  wait_ready(hal);
+OsDeltaTime RadioSx1262::init_step() {
+  switch (init_state) {
+  case InitState::START:
+    PRINT_DEBUG(1, F("Radio Init"));
+    // DIO1 is the irq pin, DIO0 is busy
+    hal.init(0x02, true);
+    // manually reset radio
+    // drive RST pin low
+    hal.pin_rst(0);
+    init_state = InitState::RESET;
+    // wait >100us for SX1262 to detect reset
+    return OsDeltaTime::from_ms(1);
+  case InitState::RESET:
+    // configure RST pin floating
+    hal.pin_rst(2);
+    init_state = InitState::BOOT;
+    // wait 5ms after reset
+    return OsDeltaTime::from_ms(5);
+  case InitState::BOOT:
+    // busy until the chip has booted, come back later instead of waiting.
+    if (hal.io_check0()) {
+      return OsDeltaTime::from_ms(1);
+    }
+    break;
+  }
+  init_state = InitState::START;
 
   if (IS_DEBUG_ENABLE(2)) {
     // Check defaut config to see if reset is ok
@@ -333,7 +326,8 @@ void RadioSx1262::init() {
   }
 
   // go to sleep without saving state
-  set_sleep();
+  set_sleep(false);
+  return OsDeltaTime(0);
 }
 
 // get random seed from wideband noise rssi
@@ -342,21 +336,64 @@ void RadioSx1262::init_random(uint8_t randbuf[16]) {
 
   init_config();
   set_rx_continious();
-  hal_wait(OsDeltaTime::from_ms(100));
+  // the random generator only need the receiver running.
+  hal_wait(OsDeltaTime::from_ms(1));
 
+  // each byte of the buffer is a xor of 4 register reads.
   Sx1262Register<4> random_register = {0x0819, {0x00}};
-  for (int i = 0; i < 4; i++) {
+  std::fill(randbuf, randbuf + 16, 0);
+  for (uint8_t i = 0; i < 16; i++) {
     read_register(hal, random_register);
     PRINT_DEBUG(2, F("Random %x %x %x %x "), random_register.data[0],
                 random_register.data[1], random_register.data[2],
                 random_register.data[3]);
-    std::copy(random_register.begin(), random_register.end(), randbuf + 4 * i);
+    for (uint8_t j = 0; j < 4; j++) {
+      randbuf[4 * (i & 3) + j] ^= random_register.data[j];
+    }
   }
   set_standby(false);
-  set_sleep();
+  set_sleep(true);
 }
 
-uint8_t RadioSx1262::rssi() const { return 0; }
+int16_t RadioSx1262::rssi() const {
+  // RSSI [dBm] = -RssiInst / 2
+  return -static_cast<int16_t>(get_rssi_inst()) / 2;
+}
+
+RadioStats RadioSx1262::stats() const {
+  Sx1262Command<6> cmd{RadioCommand::GetStats, {}};
+  read_command(hal, cmd);
+  return RadioStats{rmsbf2(cmd.parameter), rmsbf2(cmd.parameter + 2),
+                    rmsbf2(cmd.parameter + 4)};
+}
+
+// wake up from sleep with TCXO start, calibration is counted apart.
+OsDeltaTime RadioSx1262::rx_rampup() const {
+  return OsDeltaTime::from_ms(6);
+}
+
+OsDeltaTime RadioSx1262::tx_rampup() const {
+  return OsDeltaTime::from_ms(6);
+}
+
+OsDeltaTime RadioSx1262::calibration_rampup(OsTime const time) const {
+  return calibration_due(time) ? CALIBRATION_TIME : OsDeltaTime(0);
+}
+
+bool RadioSx1262::calibration_due(OsTime const time) const {
+  if (calibrating) {
+    return false;
+  }
+  return !configured || time - last_calibration >= CALIBRATION_INTERVAL;
+}
+
+void RadioSx1262::start_calibration(OsTime const time) {
+  if (!calibration_due(time)) {
+    return;
+  }
+  set_standby(awake);
+  post_calibration();
+}
 
 // called by hal ext IRQ handler
 // (radio goes to stanby mode after tx/rx operations)
@@ -364,17 +401,22 @@ uint8_t RadioSx1262::handle_end_rx(uint8_t *const framePtr) {
   uint16_t flags = get_irq_status();
 
   uint16_t const RxDone = 1 << 1;
+  uint16_t const HeaderErr = 1 << 5;
+  uint16_t const CrcErr = 1 << 6;
   uint16_t const Timeout = 1 << 9;
 
   uint8_t length = 0;
-  if (flags & RxDone) {
+  if (flags & CrcErr) {
+    // only enabled in FSK
+    PRINT_DEBUG(1, F("RX CRC error"));
+  } else if (flags & HeaderErr) {
+    // frame can't be for us, stop now.
+    PRINT_DEBUG(1, F("RX header error"));
+  } else if (flags & RxDone) {
     // read message length
-    length = read_frame(framePtr);
+    length = read_frame(framePtr, MAX_LEN_FRAME);
     // read rx quality parameters
-    // SNR [dB] * 4
-    // last_packet_snr_reg =
-    // static_cast<int8_t>(hal.read_reg(LORARegPktSnrValue)); RSSI [dBm]  - 139
-    // last_packet_rssi_reg = hal.read_reg(LORARegPktRssiValue);
+    read_packet_status();
   } else if (flags & Timeout) {
     // indicate timeout
     PRINT_DEBUG(1, F("RX timeout"));
@@ -384,29 +426,46 @@ uint8_t RadioSx1262::handle_end_rx(uint8_t *const framePtr) {
   set_dio1_irq_params(0x00);
   clear_all_irq();
 
-  set_sleep();
+  set_sleep(true);
   return length;
 }
 
-void RadioSx1262::handle_end_tx() const {
+// Below this idle time, standby (XOSC ~1.2mA) costs less than a wake up
+// from sleep with TCXO start (up to 5ms).
+constexpr OsDeltaTime STANDBY_MAX_IDLE = OsDeltaTime::from_ms(10);
+
+void RadioSx1262::handle_end_tx(OsDeltaTime const idle) {
   // no interrupt
   set_dio1_irq_params(0x00);
   clear_all_irq();
 
-  set_sleep();
+  if (idle < STANDBY_MAX_IDLE) {
+    // fallback mode left the radio in standby XOSC, next operation is
+    // close.
+    awake = true;
+    return;
+  }
+  set_sleep(true);
 }
 
-void RadioSx1262::rst() const {
+void RadioSx1262::rst() {
   // go to sleep without saving state
-  set_sleep();
+  set_sleep(false);
 }
 
-void RadioSx1262::tx(uint32_t const freq, rps_t const rps, int8_t const txpow,
-                     uint8_t const *const framePtr, uint8_t const frameLength) {
+void RadioSx1262::prepare_tx(uint32_t const freq, rps_t const rps,
+                             int8_t const txpow, uint8_t const *const framePtr,
+                             uint8_t const frameLength) {
   init_config();
   set_rf_frequency(freq);
-  set_modulation_params_lora(rps);
-  set_packet_params_lora(rps, frameLength, false);
+  if (rps.sf == FSK) {
+    set_modulation_params_fsk();
+    set_packet_params_fsk(frameLength);
+  } else {
+    set_modulation_params_lora(rps);
+    set_packet_params_lora(rps, frameLength, false);
+    set_sync_word_lora(LORA_MAC_SYNC_WORD);
+  }
   set_tx_power(txpow);
   // enable antenna switch for TX
   hal.pin_switch_antenna_tx(true);
@@ -416,28 +475,52 @@ void RadioSx1262::tx(uint32_t const freq, rps_t const rps, int8_t const txpow,
   uint16_t const TxDone = 1 << 0;
   uint16_t const Timeout = 1 << 9;
   set_dio1_irq_params(TxDone | Timeout);
+  // start synthesizer, TX can start without PLL lock delay.
+  set_fs();
+
+  if (rps.sf == FSK) {
+    PRINT_DEBUG(1, F("TXMODE FSK, freq=%" PRIu32 ", len=%d"), freq,
+                frameLength);
+  } else {
+    PRINT_DEBUG(1,
+                F("TXMODE, freq=%" PRIu32 ", len=%d, SF=%d, BW=%d, CR=4/%d"),
+                freq, frameLength, rps.sf + 6, bwForLog(rps), crForLog(rps));
+  }
+}
+
+void RadioSx1262::start_tx() {
+  hal.clear_edge();
   set_tx();
   print_status(get_status());
-
-  PRINT_DEBUG(1, F("TXMODE, freq=%" PRIu32 ", len=%d, SF=%d, BW=%d, CR=4/%d"),
-              freq, frameLength, rps.sf + 6, bwForLog(rps), crForLog(rps));
 }
 
 void RadioSx1262::rx(uint32_t const freq, rps_t const rps, uint8_t const rxsyms,
                      OsTime const rxtime) {
+  if (rps.sf == FSK) {
+    rx_fsk(freq, rxsyms, rxtime);
+    return;
+  }
   init_config();
   set_rf_frequency(freq);
   set_modulation_params_lora(rps);
   set_packet_params_lora(rps, MAX_LEN_FRAME, true);
+  set_sync_word_lora(LORA_MAC_SYNC_WORD);
+  set_rx_gain_register();
   // enable antenna switch for RX
   hal.pin_switch_antenna_tx(false);
 
   set_lora_symb_num_timeout(rxsyms);
   uint16_t const RxDone = 1 << 1;
+  uint16_t const HeaderErr = 1 << 5;
   uint16_t const Timeout = 1 << 9;
-  set_dio1_irq_params(RxDone | Timeout);
+  set_dio1_irq_params(RxDone | HeaderErr | Timeout);
   clear_all_irq();
 
+  // Stop RX if no header is found after the preamble (window, preamble,
+  // sync word and header), in step of 15.625 us.
+  uint32_t const timeout =
+      (rxsyms + HEADER_END_SYMBOLS) * symbol_time_us(rps) * 64 / 1000;
+
   // ramp up
   set_fs();
   // now instruct the radio to receive
@@ -446,8 +529,141 @@ void RadioSx1262::rx(uint32_t const freq, rps_t const rps, uint8_t const rxsyms,
     PRINT_DEBUG(1, F("RX LATE :  %" PRIu32 " WANTED, late %" PRIi32 " ms"),
                 rxtime, (os_getTime() - rxtime).to_ms());
   }
-  hal_waitUntil(rxtime);
-  set_rx();
+  wait_start(rxtime);
+  hal.clear_edge();
+  set_rx(timeout);
+}
+
+bool RadioSx1262::channel_activity(uint32_t const freq, rps_t const rps) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(rps);
+  set_cad_params(rps.sf);
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  uint16_t const CadDone = 1 << 7;
+  uint16_t const CadDetected = 1 << 8;
+  set_dio1_irq_params(CadDone | CadDetected);
+  clear_all_irq();
+
+  send_command(hal, cmds::set_cad);
+  // CAD last a few symbols, radio goes back to standby after.
+  bool const detected =
+      wait_cad_end(rps, 1 << cad_symbol_num(rps.sf), &HalIo::io_check1) &&
+      (get_irq_status() & CadDetected) != 0;
+  PRINT_DEBUG(1, F("CAD freq=%" PRIu32 ", SF=%d, detected=%d"), freq,
+              rps.sf + 6, detected);
+
+  // no interrupt
+  set_dio1_irq_params(0x00);
+  clear_all_irq();
+  set_sleep(true);
+  return detected;
+}
+
+void RadioSx1262::rx_sniff(uint32_t const freq, rps_t const rps,
+                           uint16_t const preamble_syms) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(rps);
+  set_packet_params_lora(rps, MAX_LEN_FRAME, true, preamble_syms);
+  set_sync_word_lora(LORA_MAC_SYNC_WORD);
+  set_rx_gain_register();
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  // no symbol timeout (value of last rx()), only the RX period ends a listen.
+  set_lora_symb_num_timeout(0);
+  uint16_t const RxDone = 1 << 1;
+  uint16_t const Timeout = 1 << 9;
+  set_dio1_irq_params(RxDone | Timeout);
+  clear_all_irq();
+
+  // Two RX periods and a sleep period must fit in the preamble, to have
+  // one complete RX period in it whatever the phase.
+  uint32_t const tsym = symbol_time_us(rps);
+  uint32_t const rx_us = SNIFF_RX_SYMBOLS * tsym + SNIFF_WAKEUP_US;
+  uint32_t const preamble_us = preamble_syms * tsym;
+  uint32_t const sleep_us =
+      preamble_us > 2 * rx_us ? preamble_us - 2 * rx_us : 0;
+
+  PRINT_DEBUG(1, F("RX SNIFF, freq=%" PRIu32 ", SF=%d, rx=%" PRIu32
+                   " us, sleep=%" PRIu32 " us"),
+              freq, rps.sf + 6, rx_us, sleep_us);
+  hal.clear_edge();
+  set_rx_duty_cycle(rx_us, sleep_us);
+}
+
+void RadioSx1262::tx_raw(uint32_t const freq, RawLoraConfig const &config,
+                         int8_t const txpow, uint8_t const *const framePtr,
+                         uint8_t const frameLength) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(config.rps);
+  set_packet_params_lora(config.rps, frameLength, config.invert_iq,
+                         config.preamble, config.implicit_length != 0);
+  set_sync_word_lora(config.sync_word);
+  set_tx_power(txpow);
+  // enable antenna switch for TX
+  hal.pin_switch_antenna_tx(true);
+
+  write_frame(framePtr, frameLength);
+  clear_all_irq();
+  uint16_t const TxDone = 1 << 0;
+  uint16_t const Timeout = 1 << 9;
+  set_dio1_irq_params(TxDone | Timeout);
+
+  hal.clear_edge();
+  set_tx();
+  PRINT_DEBUG(1, F("TXMODE RAW, freq=%" PRIu32 ", len=%d, SF=%d"), freq,
+              frameLength, config.rps.sf + 6);
+}
+
+void RadioSx1262::rx_raw(uint32_t const freq, RawLoraConfig const &config) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(config.rps);
+  uint8_t const length = config.implicit_length != 0 ? config.implicit_length
+                                                     : MAX_LEN_RAW_FRAME;
+  set_packet_params_lora(config.rps, length, config.invert_iq,
+                         config.preamble, config.implicit_length != 0);
+  set_sync_word_lora(config.sync_word);
+  set_rx_gain_register();
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  // continuous RX must not stop on the symbol timeout of last rx().
+  set_lora_symb_num_timeout(0);
+  uint16_t const RxDone = 1 << 1;
+  uint16_t const HeaderErr = 1 << 5;
+  uint16_t const CrcErr = 1 << 6;
+  set_dio1_irq_params(RxDone | HeaderErr | CrcErr);
+  clear_all_irq();
+
+  hal.clear_edge();
+  set_rx_continious();
+  PRINT_DEBUG(1, F("RXMODE RAW, freq=%" PRIu32 ", SF=%d"), freq,
+              config.rps.sf + 6);
+}
+
+uint8_t RadioSx1262::read_raw(uint8_t *const framePtr) {
+  uint16_t const flags = get_irq_status();
+
+  uint16_t const RxDone = 1 << 1;
+  uint16_t const HeaderErr = 1 << 5;
+  uint16_t const CrcErr = 1 << 6;
+
+  uint8_t length = 0;
+  if (flags & (HeaderErr | CrcErr)) {
+    PRINT_DEBUG(1, F("RX RAW error %x"), flags);
+  } else if (flags & RxDone) {
+    length = read_frame(framePtr, MAX_LEN_RAW_FRAME);
+    read_packet_status();
+  }
+  // stay in RX, next frame will raise DIO1 again.
+  clear_all_irq();
+  return length;
 }
 
 /**
@@ -466,11 +682,35 @@ RadioSx1262::RadioSx1262(lmic_pinmap const &pins,
                          ImageCalibrationBand const calibration_band)
     : Radio(pins),
       image_calibration_params(TABLE_GET_U2(
-          CALIBRATION_CMD, static_cast<uint8_t>(calibration_band))) {}
+          CALIBRATION_CMD, static_cast<uint8_t>(calibration_band))) {
+  forget_config();
+}
+
+void RadioSx1262::set_sleep(bool const warm_start) {
+  awake = false;
+  calibrating = false;
+  if (warm_start && configured) {
+    PRINT_DEBUG(1, F("Set Radio to sleep (warm start)"));
+    send_command(hal, cmds::set_sleep_warm_start);
+  } else {
+    PRINT_DEBUG(1, F("Set Radio to sleep"));
+    send_command(hal, cmds::set_sleep_cold_start);
+    forget_config();
+  }
+}
 
-void RadioSx1262::set_sleep() const {
-  PRINT_DEBUG(1, F("Set Radio to sleep"));
-  send_command(hal, cmds::set_sleep_cold_start);
+void RadioSx1262::forget_config() {
+  configured = false;
+  current_packet_type = 0xFF;
+  std::fill_n(current_rf_frequency, sizeof(current_rf_frequency), 0xFF);
+  std::fill_n(current_modulation_params, sizeof(current_modulation_params),
+              0xFF);
+  std::fill_n(current_packet_params, sizeof(current_packet_params), 0xFF);
+  std::fill_n(current_pa_config, sizeof(current_pa_config), 0xFF);
+  std::fill_n(current_tx_params, sizeof(current_tx_params), 0xFF);
+  std::fill_n(current_irq_params, sizeof(current_irq_params), 0xFF);
+  std::fill_n(current_sync_word, sizeof(current_sync_word), 0xFF);
+  current_rx_gain = 0xFF;
 }
 
 void RadioSx1262::set_standby(bool use_xosc) const {
@@ -479,12 +719,79 @@ void RadioSx1262::set_standby(bool use_xosc) const {
   send_command(hal, Sx1262Command<1>{RadioCommand::SetStandby, {param1}});
 }
 
-void RadioSx1262::set_packet_type_lora() const {
+void RadioSx1262::set_packet_type(uint8_t const packet_type) {
+  if (packet_type == current_packet_type)
+    return;
+  send_command(hal,
+               Sx1262Command<1>{RadioCommand::SetPacketType, {packet_type}});
+  current_packet_type = packet_type;
+  // modulation and packet parameters depend on packet type.
+  std::fill_n(current_modulation_params, sizeof(current_modulation_params),
+              0xFF);
+  std::fill_n(current_packet_params, sizeof(current_packet_params), 0xFF);
+  if (packet_type == PACKET_TYPE_GFSK) {
+    write_register(hal, cmds::set_sync_word_fsk);
+    write_register(hal, cmds::set_whitening_seed_fsk);
+  }
+}
+
+void RadioSx1262::set_modulation_params_fsk() {
+  set_packet_type(PACKET_TYPE_GFSK);
+  send_command(hal, cmds::set_modulation_params_fsk);
+}
+
+void RadioSx1262::set_packet_params_fsk(uint8_t const frameLength) {
+  send_command(hal, Sx1262Command<9>{RadioCommand::SetPacketParams,
+                                     {
+                                         // Preamble 5 bytes
+                                         0x00,
+                                         0x28,
+                                         // Preamble detector 16 bits
+                                         0x05,
+                                         // Sync word 24 bits
+                                         0x18,
+                                         // no address filtering
+                                         0x00,
+                                         // variable length
+                                         0x01,
+                                         frameLength,
+                                         // CRC 2 bytes inverted (CCITT)
+                                         0x06,
+                                         // whitening
+                                         0x01,
+                                     }});
+}
+
+void RadioSx1262::rx_fsk(uint32_t const freq, uint8_t const rxsyms,
+                         OsTime const rxtime) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_fsk();
+  set_packet_params_fsk(MAX_LEN_FRAME);
+  set_rx_gain_register();
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  uint16_t const RxDone = 1 << 1;
+  uint16_t const CrcErr = 1 << 6;
+  uint16_t const Timeout = 1 << 9;
+  set_dio1_irq_params(RxDone | CrcErr | Timeout);
+  clear_all_irq();
+
+  // timeout until sync word, rxsyms in bytes (160us) plus preamble and
+  // sync word (8 bytes), in step of 15.625 us.
+  uint32_t const timeout = (rxsyms + 8) * UINT32_C(160) * 64 / 1000;
 
-  send_command(hal, cmds::set_packet_type_lora);
+  // ramp up
+  set_fs();
+  wait_start(rxtime);
+  hal.clear_edge();
+  set_rx(timeout);
+  PRINT_DEBUG(1, F("RXMODE FSK, freq=%" PRIu32 ", rxsyms=%d"), freq, rxsyms);
 }
 
-void RadioSx1262::set_modulation_params_lora(rps_t const rps) const {
+void RadioSx1262::set_modulation_params_lora(rps_t const rps) {
+  set_packet_type(PACKET_TYPE_LORA);
   // Low Data Rate Optimization
   // Must be enabled for: SF11/BW125, SF12/BW125, SF12/BW250
   uint8_t ldro;
@@ -495,31 +802,34 @@ void RadioSx1262::set_modulation_params_lora(rps_t const rps) const {
     ldro = 0;
   }
 
-  send_command(hal, Sx1262Command<4>{RadioCommand::SetModulationParams,
-                                     {
-                                         sf_to_parameter(rps.sf),
-                                         bw_to_parameter(rps.getBw()),
-                                         cr_to_parameter(rps.getCr()),
-                                         ldro,
-                                     }});
+  Sx1262Command<4> const cmd{RadioCommand::SetModulationParams,
+                             {
+                                 sf_to_parameter(rps.sf),
+                                 bw_to_parameter(rps.getBw()),
+                                 cr_to_parameter(rps.getCr()),
+                                 ldro,
+                             }};
+  if (command_changed(cmd, current_modulation_params))
+    send_command(hal, cmd);
 }
 
-void RadioSx1262::set_rf_frequency(uint32_t const freq) const {
+void RadioSx1262::set_rf_frequency(uint32_t const freq) {
   Sx1262Command<4> cmd{RadioCommand::SetRfFrequency, {0x00}};
-  uint32_t const rf_freq = (((uint64_t)freq << 25) / 32000000);
-  wmsbf4(cmd.parameter, rf_freq);
-  send_command(hal, cmd);
+  wmsbf4(cmd.parameter, rf_frequency_steps(corrected_frequency(freq)));
+  if (command_changed(cmd, current_rf_frequency))
+    send_command(hal, cmd);
 }
 
 void RadioSx1262::set_packet_params_lora(rps_t rps, uint8_t frameLength,
-                                         bool inv) const {
+                                         bool inv, uint16_t preamble,
+                                         bool implicit_header) {
   Sx1262Command<6> cmd{RadioCommand::SetPacketParams,
                        {
                            // Preamble
-                           0x00,
-                           0x08,
-                           // explicit header
-                           0x00,
+                           static_cast<uint8_t>(preamble >> 8),
+                           static_cast<uint8_t>(preamble & 0xFF),
+                           // explicit or implicit header
+                           static_cast<uint8_t>(implicit_header ? 0x01 : 0x00),
                            // length
                            frameLength,
                            // crc
@@ -528,11 +838,18 @@ void RadioSx1262::set_packet_params_lora(rps_t rps, uint8_t frameLength,
                            static_cast<uint8_t>(inv ? 0x01 : 0x00),
                        }};
 
-  send_command(hal, cmd);
+  if (command_changed(cmd, current_packet_params))
+    send_command(hal, cmd);
 }
 
-void RadioSx1262::set_sync_word_lora() const {
-  write_register(hal, cmds::set_sync_word_lora);
+void RadioSx1262::set_sync_word_lora(uint8_t const sync_word) {
+  // each nibble n is written (n << 4) | 0x4 : 0x34 => 0x34, 0x44
+  uint8_t const value[2] = {static_cast<uint8_t>((sync_word & 0xF0) | 0x04),
+                            static_cast<uint8_t>((sync_word << 4) | 0x04)};
+  if (std::equal(value, value + sizeof(value), current_sync_word))
+    return;
+  std::copy(value, value + sizeof(value), current_sync_word);
+  write_register(hal, REG_LORA_SYNC_WORD, value, sizeof(value));
 }
 
 void RadioSx1262::set_regulator_mode_dcdc() const {
@@ -540,35 +857,80 @@ void RadioSx1262::set_regulator_mode_dcdc() const {
   send_command(hal, Sx1262Command<1>{RadioCommand::SetRegulatorMode, {0x01}});
 }
 
-void RadioSx1262::init_config() const {
+void RadioSx1262::set_rx_gain_register() {
+  uint8_t const value = rx_gain == RxGain::BOOSTED ? RX_GAIN_BOOSTED
+                                                   : RX_GAIN_POWER_SAVING;
+  if (value == current_rx_gain)
+    return;
+  current_rx_gain = value;
+  write_register(hal, Sx1262Register<1>{REG_RX_GAIN, {value}});
+}
+
+void RadioSx1262::init_config() {
+  if (!calibrating) {
+    // Wakeup, or stop current operation keeping the oscillator on.
+    set_standby(awake);
+    if (!calibration_due(os_getTime())) {
+      // configuration and calibration retained in warm start sleep
+      return;
+    }
+    post_calibration();
+  }
+  calibrating = false;
+  // wait the end of the calibration
+  set_standby(true);
+
+  set_DIO2_as_rf_switch_ctrl();
+  send_command(hal, cmds::stop_timer_on_header);
+  send_command(hal, cmds::set_fallback_stdby_xosc);
+  write_register(hal, Sx1262Register<3>{REG_RETENTION_LIST,
+                                        {0x01, REG_RX_GAIN >> 8,
+                                         REG_RX_GAIN & 0xFF}});
+
+  configured = true;
+}
+
+// Commands are only posted: the MCU is free until the next command.
+void RadioSx1262::post_calibration() {
   PRINT_DEBUG(1, F("Init Configure"));
-  // Wakeup
-  set_standby(false);
   set_regulator_mode_dcdc();
 
   // BOARD have TCXO, need calibration
   calibrate_image();
   set_DIO3_as_tcxo_ctrl();
   calibrate_all();
-  set_standby(true);
-
-  set_DIO2_as_rf_switch_ctrl();
-  set_packet_type_lora();
-  set_sync_word_lora();
+  calibrating = true;
+  last_calibration = os_getTime();
 }
 
-void RadioSx1262::set_tx_power(int8_t const txpow) const {
+void RadioSx1262::set_tx_power(int8_t const txpow) {
   // high power PA: -9 ... +22 dBm
   int8_t const min_limit = -9;
   int8_t const max_limit = 22;
   int8_t const pw = clamp(txpow, min_limit, max_limit);
 
-  // set PA config (and reset OCP to 140mA)
-  send_command(hal, Sx1262Command<4>{RadioCommand::SetPaConfig,
-                                     {0x04, 0x07, 0x00, 0x01}});
+  uint8_t index = 0;
+  while (index < NB_PA_CONFIG - 1 &&
+         pw > static_cast<int8_t>(
+                  TABLE_GET_U1_TWODIM(PA_CONFIG, index, 0))) {
+    index++;
+  }
+  auto const pa_max = static_cast<int8_t>(
+      TABLE_GET_U1_TWODIM(PA_CONFIG, index, 0));
+  // set PA config (and reset OCP to 140mA), high power PA.
+  Sx1262Command<4> const pa_config{RadioCommand::SetPaConfig,
+                                   {TABLE_GET_U1_TWODIM(PA_CONFIG, index, 1),
+                                    TABLE_GET_U1_TWODIM(PA_CONFIG, index, 2),
+                                    0x00, 0x01}};
+  if (command_changed(pa_config, current_pa_config))
+    send_command(hal, pa_config);
+
   // ramp up 200ms
-  send_command(hal, Sx1262Command<2>{RadioCommand::SetTxParams,
-                                     {static_cast<uint8_t>(pw), 0x04}});
+  Sx1262Command<2> const tx_params{
+      RadioCommand::SetTxParams,
+      {static_cast<uint8_t>(max_limit - (pa_max - pw)), 0x04}};
+  if (command_changed(tx_params, current_tx_params))
+    send_command(hal, tx_params);
 }
 
 void RadioSx1262::write_frame(uint8_t const *framePtr,
@@ -583,20 +945,18 @@ void RadioSx1262::write_frame(uint8_t const *framePtr,
   hal.spi(RadioCommand::WriteBuffer);
   // offset
   hal.spi(0x00);
-
-  std::for_each(framePtr, framePtr + frameLength,
-                [this](uint8_t const val) { hal.spi(val); });
-
+  hal.spi_write(framePtr, frameLength);
   hal.endspi();
 }
 
-uint8_t RadioSx1262::read_frame(uint8_t *framePtr) const {
+uint8_t RadioSx1262::read_frame(uint8_t *framePtr,
+                                uint8_t const max_length) const {
   // read frame status
   Sx1262Command<2> frame_status = {RadioCommand::GetRxBufferStatus,
                                    {0x00, 0x00}};
   read_command(hal, frame_status);
 
-  uint8_t const len = std::min(frame_status.parameter[0], MAX_LEN_FRAME);
+  uint8_t const len = std::min(frame_status.parameter[0], max_length);
   uint8_t const offset = frame_status.parameter[1];
 
   hal.beginspi();
@@ -604,9 +964,7 @@ uint8_t RadioSx1262::read_frame(uint8_t *framePtr) const {
   hal.spi(RadioCommand::ReadBuffer);
   hal.spi(offset);
   hal.spi(0x00);
-
-  std::generate_n(framePtr, len, [this]() { return hal.spi(0x00); });
-
+  hal.spi_read(framePtr, len);
   hal.endspi();
   return len;
 }
@@ -636,30 +994,86 @@ void RadioSx1262::clear_all_irq() const {
   send_command(hal, cmds::clear_all_irq);
 }
 
-void RadioSx1262::set_dio1_irq_params(uint16_t mask) const {
+void RadioSx1262::set_dio1_irq_params(uint16_t mask) {
 
   auto const maskH = static_cast<uint8_t>(mask >> 8);
   auto maskL = static_cast<uint8_t>(mask & 0xFF);
 
-  send_command(hal, Sx1262Command<8>{RadioCommand::SetDioIrqParams,
-                                     {maskH, maskL,
-                                      // DIO1
-                                      maskH, maskL,
-                                      // DIO2
-                                      0x00, 0x00,
-                                      // DIO 3
-                                      0x00, 0x00}});
+  Sx1262Command<8> const cmd{RadioCommand::SetDioIrqParams,
+                             {maskH, maskL,
+                              // DIO1
+                              maskH, maskL,
+                              // DIO2
+                              0x00, 0x00,
+                              // DIO 3
+                              0x00, 0x00}};
+  if (command_changed(cmd, current_irq_params))
+    send_command(hal, cmd);
 }
 
-void RadioSx1262::set_rx() const {
-  // Timeout 0 (symbol timeout)
-  send_command(hal, cmds::set_rx);
+void RadioSx1262::set_rx(uint32_t const timeout) const {
+  send_command(hal, Sx1262Command<3>{RadioCommand::SetRx,
+                                     {static_cast<uint8_t>(timeout >> 16),
+                                      static_cast<uint8_t>(timeout >> 8),
+                                      static_cast<uint8_t>(timeout)}});
 }
 
 void RadioSx1262::set_rx_continious() const {
   send_command(hal, cmds::set_rx_continious);
 }
 
+void RadioSx1262::read_packet_status() {
+  Sx1262Command<3> cmd{RadioCommand::GetPacketStatus, {}};
+  read_command(hal, cmd);
+  if (current_packet_type == PACKET_TYPE_GFSK) {
+    // RxStatus, RssiSync, RssiAvg, no SNR in FSK
+    store_packet_quality(-static_cast<int16_t>(cmd.parameter[1]) / 2, 0);
+    return;
+  }
+  // RssiPkt, SnrPkt, SignalRssiPkt
+  // RSSI [dBm] = -RssiPkt / 2
+  int16_t const rssi = -static_cast<int16_t>(cmd.parameter[0]) / 2;
+  // SNR [dB] * 4
+  auto const snr = static_cast<int8_t>(cmd.parameter[1]);
+  PRINT_DEBUG(2, F("Packet RSSI %i dBm, SNR*4 %i"), rssi, snr);
+  store_packet_quality(rssi, snr);
+  store_frequency_error(read_frequency_error());
+}
+
+// frequency error [Hz] = FreqError * 1.55 * BW / 1600kHz
+int32_t RadioSx1262::read_frequency_error() const {
+  Sx1262Register<3> reg{REG_FREQ_ERROR, {}};
+  read_register(hal, reg);
+  int32_t const raw =
+      static_cast<int32_t>(static_cast<uint32_t>(reg.data[0]) << 28 |
+                           static_cast<uint32_t>(reg.data[1]) << 20 |
+                           static_cast<uint32_t>(reg.data[2]) << 12) >>
+      12;
+  // BW parameter 0x04 is 125kHz, 0x05 250kHz, 0x06 500kHz
+  int32_t const bw_khz = INT32_C(125) << (current_modulation_params[1] - 0x04);
+  return static_cast<int32_t>(static_cast<int64_t>(raw) * bw_khz * 155 /
+                              160000);
+}
+
+void RadioSx1262::set_rx_duty_cycle(uint32_t const rx_us,
+                                    uint32_t const sleep_us) const {
+  // periods in step of 15.625 us (24 bits)
+  uint32_t const rx_period = std::min<uint32_t>(rx_us * 64 / 1000, 0xFFFFFF);
+  uint32_t const sleep_period =
+      std::min<uint32_t>(sleep_us * 64 / 1000, 0xFFFFFF);
+  Sx1262Command<6> const cmd{
+      RadioCommand::SetRxDutyCycle,
+      {
+          static_cast<uint8_t>(rx_period >> 16),
+          static_cast<uint8_t>(rx_period >> 8),
+          static_cast<uint8_t>(rx_period),
+          static_cast<uint8_t>(sleep_period >> 16),
+          static_cast<uint8_t>(sleep_period >> 8),
+          static_cast<uint8_t>(sleep_period),
+      }};
+  send_command(hal, cmd);
+}
+
 uint8_t RadioSx1262::get_rssi_inst() const {
   Sx1262Command<1> cmd{RadioCommand::GetRssiInst, {}};
   read_command(hal, cmd);
@@ -670,6 +1084,16 @@ void RadioSx1262::set_tx() const { send_command(hal, cmds::set_tx_10s); }
 
 void RadioSx1262::set_fs() const { send_command(hal, cmds::set_fs); }
 
+void RadioSx1262::set_cad_params(sf_t const sf) const {
+  uint8_t const index = sf - SF7;
+  send_command(hal, Sx1262Command<7>{RadioCommand::SetCadParams,
+                                     {cad_symbol_num(sf),
+                                      TABLE_GET_U1(CAD_DET_PEAK, index),
+                                      CAD_DET_MIN,
+                                      // CAD_ONLY, no timeout
+                                      0x00, 0x00, 0x00, 0x00}});
+}
+
 void RadioSx1262::set_lora_symb_num_timeout(uint8_t rxsyms) const {
   cmds::SetLoraSymbNumCommand cmd;
   cmd.set_lora_symb_num(rxsyms);
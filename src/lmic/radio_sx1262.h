@@ -22,50 +22,95 @@ class RadioSx1262 final : public Radio {
 private:
   // ImageCalibrationBand const image_calibration_band;
   uint16_t const image_calibration_params;
+
+  // Configuration applied to the chip, retained in warm start sleep.
+  // Used to skip command when value do not change.
+  bool configured = false;
+  // not in sleep, left in standby (XOSC) after TX.
+  bool awake = false;
+  // calibration posted, the configuration ends in next init_config().
+  bool calibrating = false;
+  OsTime last_calibration;
+  uint8_t current_packet_type;
+  uint8_t current_rf_frequency[4];
+  uint8_t current_modulation_params[4];
+  uint8_t current_packet_params[6];
+  uint8_t current_pa_config[4];
+  uint8_t current_tx_params[2];
+  uint8_t current_irq_params[8];
+  uint8_t current_sync_word[2];
+  uint8_t current_rx_gain;
+
 public:
   explicit RadioSx1262(lmic_pinmap const &pins,
                        ImageCalibrationBand calibration_band);
-  void init() final;
-  void rst() const final;
-  void tx(uint32_t freq, rps_t rps, int8_t txpow, uint8_t const *framePtr,
-          uint8_t frameLength) final;
-  void rx(uint32_t freq, rps_t rps, uint8_t rxsyms, OsTime rxtime) final;
+  OsDeltaTime init_step() RADIO_FINAL;
+  void rst() RADIO_FINAL;
+  void prepare_tx(uint32_t freq, rps_t rps, int8_t txpow,
+                  uint8_t const *framePtr, uint8_t frameLength) RADIO_FINAL;
+  void start_tx() RADIO_FINAL;
+  void rx(uint32_t freq, rps_t rps, uint8_t rxsyms, OsTime rxtime) RADIO_FINAL;
 
-  void init_random(uint8_t randbuf[16]) final;
-  uint8_t handle_end_rx(uint8_t *framePtr) final;
-  void handle_end_tx() const final;
-  bool io_check() const final;
+  bool channel_activity(uint32_t freq, rps_t rps) RADIO_FINAL;
+  void rx_sniff(uint32_t freq, rps_t rps, uint16_t preamble_syms) RADIO_FINAL;
+  void tx_raw(uint32_t freq, RawLoraConfig const &config, int8_t txpow,
+              uint8_t const *framePtr, uint8_t frameLength) RADIO_FINAL;
+  void rx_raw(uint32_t freq, RawLoraConfig const &config) RADIO_FINAL;
+  uint8_t read_raw(uint8_t *framePtr) RADIO_FINAL;
+  void init_random(uint8_t randbuf[16]) RADIO_FINAL;
+  uint8_t handle_end_rx(uint8_t *framePtr) RADIO_FINAL;
+  void handle_end_tx(OsDeltaTime idle) RADIO_FINAL;
+  bool io_check() const RADIO_FINAL;
 
-  uint8_t rssi() const final;
+  int16_t rssi() const RADIO_FINAL;
+  RadioStats stats() const RADIO_FINAL;
+  OsDeltaTime rx_rampup() const RADIO_FINAL;
+  OsDeltaTime tx_rampup() const RADIO_FINAL;
+  OsDeltaTime calibration_rampup(OsTime time) const RADIO_FINAL;
+  void start_calibration(OsTime time) RADIO_FINAL;
 
 private:
-  void set_sleep() const;
+  bool calibration_due(OsTime time) const;
+  void set_sleep(bool warm_start);
   void set_standby(bool use_xosc) const;
-  void set_packet_type_lora() const;
-  void set_modulation_params_lora(rps_t rps) const;
-  void set_rf_frequency(uint32_t freq) const;
-  void set_sync_word_lora() const;
-  void set_packet_params_lora(rps_t rps, uint8_t frameLength, bool inv) const;
-  void set_tx_power(int8_t txpow) const;
+  void set_packet_type(uint8_t packet_type);
+  void set_modulation_params_fsk();
+  void set_packet_params_fsk(uint8_t frameLength);
+  void rx_fsk(uint32_t freq, uint8_t rxsyms, OsTime rxtime);
+  void set_modulation_params_lora(rps_t rps);
+  void set_rf_frequency(uint32_t freq);
+  void set_sync_word_lora(uint8_t sync_word);
+  void set_rx_gain_register();
+  void set_packet_params_lora(rps_t rps, uint8_t frameLength, bool inv,
+                              uint16_t preamble = 8,
+                              bool implicit_header = false);
+  void set_tx_power(int8_t txpow);
   void set_regulator_mode_dcdc() const;
 
-  void init_config() const;
+  void init_config();
+  void post_calibration();
+  void forget_config();
 
   void write_frame(uint8_t const *framePtr, uint8_t frameLength) const;
-  uint8_t read_frame(uint8_t *framePtr) const;
+  uint8_t read_frame(uint8_t *framePtr, uint8_t max_length) const;
   uint8_t get_status() const;
   uint16_t get_device_errors() const;
   uint16_t get_irq_status() const;
 
   void clear_all_irq() const;
-  void set_dio1_irq_params(uint16_t mask) const;
-  void set_rx() const;
+  void set_dio1_irq_params(uint16_t mask);
+  // timeout in step of 15.625us (0 = single RX with symbol timeout)
+  void set_rx(uint32_t timeout) const;
   void set_rx_continious() const;
+  void set_rx_duty_cycle(uint32_t rx_us, uint32_t sleep_us) const;
   void set_tx() const;
   void set_fs() const;
+  void set_cad_params(sf_t sf) const;
   void set_lora_symb_num_timeout(uint8_t rxsyms) const;
   void calibrate_image() const;
   uint8_t get_rssi_inst() const;
+  void read_packet_status();
+  int32_t read_frequency_error() const;
   void set_DIO2_as_rf_switch_ctrl() const;
   void calibrate_all() const;
   void clear_device_errors() const;
@@ -0,0 +1,1156 @@
+/*******************************************************************************
+ * Copyright (c) 2014-2015 IBM Corporation.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors:
+ *    IBM Zurich Research Lab - initial API, implementation and documentation
+ *    Nicolas Graziano - cpp style.
+ *******************************************************************************/
+
+#include "radio_sx127x.h"
+#include "../hal/print_debug.h"
+
+#include "../aes/lmic_aes.h"
+#include "bufferpack.h"
+#include "lmic_table.h"
+#include <algorithm>
+
+namespace {
+// ----------------------------------------
+// Registers Mapping
+constexpr uint8_t RegFifo = 0x00;     // common
+constexpr uint8_t RegOpMode = 0x01;   // common
+constexpr uint8_t RegFrfMsb = 0x06;   // common
+constexpr uint8_t RegFrfMid = 0x07;   // common
+constexpr uint8_t RegFrfLsb = 0x08;   // common
+constexpr uint8_t RegPaConfig = 0x09; // common
+constexpr uint8_t RegPaRamp = 0x0A;   // common
+constexpr uint8_t RegOcp = 0x0B;      // common
+constexpr uint8_t RegLna = 0x0C;      // common
+constexpr uint8_t LORARegFifoAddrPtr = 0x0D;
+constexpr uint8_t LORARegFifoTxBaseAddr = 0x0E;
+constexpr uint8_t LORARegFifoRxBaseAddr = 0x0F;
+constexpr uint8_t LORARegFifoRxCurrentAddr = 0x10;
+constexpr uint8_t LORARegIrqFlagsMask = 0x11;
+constexpr uint8_t LORARegIrqFlags = 0x12;
+constexpr uint8_t LORARegRxNbBytes = 0x13;
+constexpr uint8_t LORARegRxHeaderCntValueMsb = 0x14;
+constexpr uint8_t LORARegRxHeaderCntValueLsb = 0x15;
+constexpr uint8_t LORARegRxPacketCntValueMsb = 0x16;
+constexpr uint8_t LORARegRxpacketCntValueLsb = 0x17;
+constexpr uint8_t LORARegModemStat = 0x18;
+constexpr uint8_t LORARegPktSnrValue = 0x19;
+constexpr uint8_t LORARegPktRssiValue = 0x1A;
+constexpr uint8_t LORARegRssiValue = 0x1B;
+constexpr uint8_t LORARegHopChannel = 0x1C;
+constexpr uint8_t LORARegModemConfig1 = 0x1D;
+constexpr uint8_t LORARegModemConfig2 = 0x1E;
+constexpr uint8_t LORARegSymbTimeoutLsb = 0x1F;
+constexpr uint8_t LORARegPreambleMsb = 0x20;
+constexpr uint8_t LORARegPreambleLsb = 0x21;
+constexpr uint8_t LORARegPayloadLength = 0x22;
+constexpr uint8_t LORARegPayloadMaxLength = 0x23;
+constexpr uint8_t LORARegHopPeriod = 0x24;
+constexpr uint8_t LORARegFifoRxByteAddr = 0x25;
+constexpr uint8_t LORARegModemConfig3 = 0x26;
+constexpr uint8_t LORARegFeiMsb = 0x28;
+constexpr uint8_t LORAFeiMib = 0x29;
+constexpr uint8_t LORARegFeiLsb = 0x2A;
+constexpr uint8_t LORARegRssiWideband = 0x2C;
+constexpr uint8_t LORARegDetectOptimize = 0x31;
+constexpr uint8_t LORARegInvertIQ = 0x33;
+constexpr uint8_t LORARegDetectionThreshold = 0x37;
+constexpr uint8_t LORARegSyncWord = 0x39;
+// FSK registers (same address space as LoRa ones)
+constexpr uint8_t FSKRegBitrateMsb = 0x02;
+constexpr uint8_t FSKRegBitrateLsb = 0x03;
+constexpr uint8_t FSKRegFdevMsb = 0x04;
+constexpr uint8_t FSKRegFdevLsb = 0x05;
+constexpr uint8_t FSKRegRxConfig = 0x0D;
+constexpr uint8_t FSKRegRssiValue = 0x11;
+constexpr uint8_t FSKRegRxBw = 0x12;
+constexpr uint8_t FSKRegAfcBw = 0x13;
+constexpr uint8_t FSKRegPreambleDetect = 0x1F;
+constexpr uint8_t FSKRegRxTimeout2 = 0x21;
+constexpr uint8_t FSKRegPreambleMsb = 0x25;
+constexpr uint8_t FSKRegPreambleLsb = 0x26;
+constexpr uint8_t FSKRegSyncConfig = 0x27;
+constexpr uint8_t FSKRegSyncValue1 = 0x28;
+constexpr uint8_t FSKRegSyncValue2 = 0x29;
+constexpr uint8_t FSKRegSyncValue3 = 0x2A;
+constexpr uint8_t FSKRegPacketConfig1 = 0x30;
+constexpr uint8_t FSKRegPacketConfig2 = 0x31;
+constexpr uint8_t FSKRegPayloadLength = 0x32;
+constexpr uint8_t FSKRegIrqFlags1 = 0x3E;
+constexpr uint8_t FSKRegIrqFlags2 = 0x3F;
+// first and last register of the modem dependent page
+constexpr uint8_t RegModemPageFirst = 0x0D;
+constexpr uint8_t RegModemPageLast = 0x3F;
+
+constexpr uint8_t RegDioMapping1 = 0x40; // common
+constexpr uint8_t RegDioMapping2 = 0x41; // common
+constexpr uint8_t RegVersion = 0x42;     // common
+
+// ----------------------------------------
+// spread factors and mode for RegModemConfig2
+constexpr uint8_t sf_to_mc2(sf_t sf) { return (7 - SF7 + sf) << 4; }
+
+// RegModemConfig1 (bandwidth 125, 250, 500 kHz are consecutive values)
+template <class Chip> constexpr uint8_t bw_to_mc1(BandWidth bw) {
+  return (Chip::mc1_bw_125 - static_cast<uint8_t>(BandWidth::BW125) +
+          static_cast<uint8_t>(bw))
+         << Chip::mc1_bw_shift;
+}
+
+constexpr uint8_t MC1_IDX_CR_4_5 = 1;
+constexpr uint8_t MC1_IDX_CR_4_6 = 2;
+constexpr uint8_t MC1_IDX_CR_4_7 = 3;
+constexpr uint8_t MC1_IDX_CR_4_8 = 4;
+
+template <class Chip> constexpr uint8_t cr_to_mc1(CodingRate cr) {
+  return (MC1_IDX_CR_4_5 - static_cast<uint8_t>(CodingRate::CR_4_5) +
+          static_cast<uint8_t>(cr))
+         << Chip::mc1_cr_shift;
+}
+
+// RegModemConfig3 (SX1276)
+constexpr uint8_t MC3_LOW_DATA_RATE_OPTIMIZE = 0x08;
+constexpr uint8_t MC3_AGCAUTO = 0x04;
+
+// preamble for lora networks (nibbles swapped)
+constexpr uint8_t LORA_MAC_PREAMBLE = 0x34;
+
+constexpr uint8_t RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG1 = 0x0A;
+constexpr uint8_t RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG2 = 0x70;
+
+// ----------------------------------------
+// Constants for radio registers
+constexpr uint8_t OPMODE_LORA = 0x80;
+// FSK modem (shaping bits are chip dependent)
+constexpr uint8_t OPMODE_FSK = 0x00;
+constexpr uint8_t OPMODE_MASK = 0x07;
+constexpr uint8_t OPMODE_SLEEP = 0x00;
+constexpr uint8_t OPMODE_STANDBY = 0x01;
+constexpr uint8_t OPMODE_FSTX = 0x02;
+constexpr uint8_t OPMODE_TX = 0x03;
+constexpr uint8_t OPMODE_FSRX = 0x04;
+constexpr uint8_t OPMODE_RX = 0x05;
+constexpr uint8_t OPMODE_RX_SINGLE = 0x06;
+constexpr uint8_t OPMODE_CAD = 0x07;
+
+// ----------------------------------------
+// Bits masking the corresponding IRQs from the radio
+constexpr uint8_t IRQ_LORA_RXTOUT_MASK = 0x80;
+constexpr uint8_t IRQ_LORA_RXDONE_MASK = 0x40;
+constexpr uint8_t IRQ_LORA_CRCERR_MASK = 0x20;
+constexpr uint8_t IRQ_LORA_HEADER_MASK = 0x10;
+constexpr uint8_t IRQ_LORA_TXDONE_MASK = 0x08;
+constexpr uint8_t IRQ_LORA_CDDONE_MASK = 0x04;
+constexpr uint8_t IRQ_LORA_FHSSCH_MASK = 0x02;
+constexpr uint8_t IRQ_LORA_CDDETD_MASK = 0x01;
+
+constexpr uint8_t IRQ_FSK1_TIMEOUT_MASK = 0x04;
+constexpr uint8_t IRQ_FSK2_PAYLOADREADY_MASK = 0x04;
+constexpr uint8_t IRQ_FSK2_CRCOK_MASK = 0x02;
+
+// ----------------------------------------
+// DIO function mappings                D0D1D2D3
+constexpr uint8_t MAP_DIO0_LORA_RXDONE = 0x00; // 00------
+constexpr uint8_t MAP_DIO0_LORA_TXDONE = 0x40; // 01------
+constexpr uint8_t MAP_DIO0_LORA_NOP = 0xC0;    // 11------
+constexpr uint8_t MAP_DIO0_LORA_CADDONE = 0x80; // 10------
+constexpr uint8_t MAP_DIO1_LORA_RXTOUT = 0x00; // --00----
+constexpr uint8_t MAP_DIO1_LORA_NOP = 0x30;    // --11----
+constexpr uint8_t MAP_DIO1_LORA_CADDETD = 0x20; // --10----
+constexpr uint8_t MAP_DIO2_LORA_NOP = 0x0C;    // ----11--
+constexpr uint8_t MAP_DIO0_FSK_READY = 0x00;   // 00------ (packet sent / rx)
+constexpr uint8_t MAP_DIO1_FSK_NOP = 0x30;     // --11----
+constexpr uint8_t MAP_DIO2_FSK_TXNOP = 0x04;   // ----01--
+constexpr uint8_t MAP_DIO2_FSK_TIMEOUT = 0x08; // ----10--
+
+// LNA max gain (set by AGC when on), boost HF: 150% LNA current
+constexpr uint8_t LNA_RX_GAIN = (0x20 | 0x03);
+constexpr uint8_t LNA_RX_GAIN_POWER_SAVING = 0x20;
+
+constexpr uint8_t crForLog(rps_t const &rps) {
+  return (5 - static_cast<uint8_t>(CodingRate::CR_4_5) +
+          static_cast<uint8_t>(rps.getCr()));
+}
+
+CONST_TABLE(uint16_t, BW_ENUM_TO_VAL)[] = {125, 250, 500, 0};
+
+uint16_t bwForLog(rps_t const &rps) {
+  auto index = static_cast<uint8_t>(rps.getBw());
+  return TABLE_GET_U2(BW_ENUM_TO_VAL, index);
+}
+
+// ----------------------------------------
+// Shadow of configuration registers.
+// Only registers not modified by the radio itself are kept.
+constexpr uint8_t NO_SHADOW = 0xFF;
+constexpr uint8_t shadow_index(uint8_t const reg, uint8_t const reg_pa_dac) {
+  return (reg >= RegFrfMsb && reg <= RegLna) ? reg - RegFrfMsb
+         : (reg >= LORARegModemConfig1 && reg <= LORARegHopPeriod)
+             ? reg - LORARegModemConfig1 + 7
+         : reg == LORARegModemConfig3   ? 15
+         : reg == LORARegFifoTxBaseAddr ? 16
+         : reg == LORARegIrqFlagsMask   ? 17
+         : reg == LORARegInvertIQ       ? 18
+         : reg == LORARegSyncWord       ? 19
+         : reg == RegDioMapping1        ? 20
+         : reg == reg_pa_dac            ? 21
+                                        : NO_SHADOW;
+}
+
+} // namespace
+
+// index in shadow copy, registers of the FSK page are not kept.
+template <class Chip>
+uint8_t RadioSx127x<Chip>::shadow_slot(uint8_t const addr) const {
+  if (modem != OPMODE_LORA && addr >= RegModemPageFirst &&
+      addr <= RegModemPageLast) {
+    return NO_SHADOW;
+  }
+  return shadow_index(addr, Chip::reg_pa_dac);
+}
+
+template <class Chip>
+bool RadioSx127x<Chip>::shadow_match(uint8_t const addr,
+                                     uint8_t const data) const {
+  uint8_t const index = shadow_slot(addr);
+  return index != NO_SHADOW && (shadow_valid & (UINT32_C(1) << index)) &&
+         shadow_reg[index] == data;
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::shadow_store(uint8_t const addr, uint8_t const data) {
+  uint8_t const index = shadow_slot(addr);
+  if (index != NO_SHADOW) {
+    shadow_reg[index] = data;
+    shadow_valid |= UINT32_C(1) << index;
+  }
+}
+
+// write register only if value is not already set.
+template <class Chip>
+void RadioSx127x<Chip>::write_reg(uint8_t const addr, uint8_t const data) {
+  if (shadow_match(addr, data)) {
+    return;
+  }
+  hal.write_reg(addr, data);
+  shadow_store(addr, data);
+}
+
+// write consecutive registers, skip unchanged value at start and end.
+template <class Chip>
+void RadioSx127x<Chip>::write_regs(uint8_t addr, uint8_t const *data,
+                                   uint8_t len) {
+  while (len > 0 && shadow_match(addr, data[0])) {
+    addr++;
+    data++;
+    len--;
+  }
+  while (len > 0 && shadow_match(addr + len - 1, data[len - 1])) {
+    len--;
+  }
+  if (len == 0) {
+    return;
+  }
+  hal.write_buffer(addr, data, len);
+  for (uint8_t i = 0; i < len; i++) {
+    shadow_store(addr + i, data[i]);
+  }
+}
+
+// read register from shadow copy if known.
+template <class Chip>
+uint8_t RadioSx127x<Chip>::read_reg(uint8_t const addr) {
+  uint8_t const index = shadow_slot(addr);
+  if (index != NO_SHADOW && (shadow_valid & (UINT32_C(1) << index))) {
+    return shadow_reg[index];
+  }
+  uint8_t const val = hal.read_reg(addr);
+  shadow_store(addr, val);
+  return val;
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::write_list_of_reg(uint16_t const *const listcmd,
+                                          uint8_t nb_cmd) {
+  for (uint8_t i = 0; i < nb_cmd; i++) {
+    RegSet cmd{table_get_u2(listcmd, i)};
+    write_reg(cmd.reg, cmd.val);
+  }
+}
+
+// Modem is known, no need to read the register.
+template <class Chip>
+void RadioSx127x<Chip>::opmode(uint8_t const mode) {
+  // any new mode ends the LoRa RX waiting for its header (rst, tx, cad...)
+  header_pending = false;
+  hal.write_reg(RegOpMode, modem | mode);
+}
+
+// modem can only be changed in sleep mode (radio sleep between operations).
+template <class Chip>
+void RadioSx127x<Chip>::opmodeLora() {
+  modem = OPMODE_LORA;
+  hal.write_reg(RegOpMode, OPMODE_LORA);
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::opmodeFsk() {
+  modem = OPMODE_FSK | Chip::opmode_fsk_shaping;
+  hal.write_reg(RegOpMode, modem);
+}
+
+// configure LoRa modem (cfg1, cfg2)
+template <class Chip>
+void RadioSx127x<Chip>::configLoraModem(rps_t rps,
+                                        bool const implicit_header) {
+  auto const sf = rps.sf;
+
+  bool const low_data_rate =
+      ((sf == SF11 || sf == SF12) && rps.getBw() == BandWidth::BW125) ||
+      (sf == SF12 && rps.getBw() == BandWidth::BW250);
+
+  uint8_t mc[2];
+  // ModemConfig1
+  mc[0] = bw_to_mc1<Chip>(rps.getBw()) | cr_to_mc1<Chip>(rps.getCr());
+  // ModemConfig2
+  mc[1] = sf_to_mc2(sf) | Chip::mc2_agc_auto;
+  if (!rps.nocrc) {
+    mc[0] |= Chip::mc1_crc_on;
+    mc[1] |= Chip::mc2_crc_on;
+  }
+  if (low_data_rate) {
+    mc[0] |= Chip::mc1_low_data_rate;
+  }
+  if (implicit_header) {
+    mc[0] |= Chip::mc1_implicit_header;
+  }
+  write_regs(LORARegModemConfig1, mc, sizeof(mc));
+
+  if (Chip::has_mc3) {
+    uint8_t mc3 = MC3_AGCAUTO;
+    if (low_data_rate) {
+      mc3 |= MC3_LOW_DATA_RATE_OPTIMIZE;
+    }
+    write_reg(LORARegModemConfig3, mc3);
+  }
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::configChannel(uint32_t const freq) {
+  // set frequency: FQ = (FRF * 32 Mhz) / (2 ^ 19)
+  uint64_t const frf = ((uint64_t)corrected_frequency(freq) << 19) / 32000000;
+  uint8_t const buf[3] = {(uint8_t)(frf >> 16), (uint8_t)(frf >> 8),
+                          (uint8_t)(frf >> 0)};
+  // RegFrfMsb, RegFrfMid, RegFrfLsb
+  write_regs(RegFrfMsb, buf, sizeof(buf));
+}
+
+// TX outputs for each power range, the first one able to give the power
+// is used: RFO draw less current than PA_BOOST.
+// {max power dBm, RegPaConfig at max power}, power is reduced by
+// OutputPower (low nibble).
+namespace {
+struct PaRange {
+  int8_t max;
+  uint8_t config;
+};
+
+template <class Chip> constexpr PaRange pa_range(uint8_t const index) {
+  return index == 0 ? PaRange{Chip::rfo_low_max, Chip::rfo_low_config}
+         : index == 1
+             ? PaRange{Chip::rfo_high_max, Chip::rfo_high_config}
+             // PA_BOOST: Pout = 17 - (15 - OutputPower), no boost +20dBm
+             // for now.
+             : PaRange{17, 0x8F};
+}
+} // namespace
+
+// ranges usable with the board outputs.
+#if defined(LMIC_SX127X_RFO_AND_PA_BOOST)
+constexpr uint8_t PA_RANGE_FIRST = 0;
+constexpr uint8_t PA_RANGE_LAST = 2;
+#elif defined(LMIC_SX127X_RFO)
+constexpr uint8_t PA_RANGE_FIRST = 0;
+constexpr uint8_t PA_RANGE_LAST = 1;
+#else
+constexpr uint8_t PA_RANGE_FIRST = 2;
+constexpr uint8_t PA_RANGE_LAST = 2;
+#endif
+
+template <class Chip>
+void RadioSx127x<Chip>::configPower(int8_t const txpow) {
+  uint8_t index = PA_RANGE_FIRST;
+  while (index < PA_RANGE_LAST && txpow > pa_range<Chip>(index).max) {
+    index++;
+  }
+  PaRange const range = pa_range<Chip>(index);
+  // OutputPower 0 to 15
+  int8_t const min_limit = range.max - (range.config & 0x0F);
+  int8_t const pw = clamp(txpow, min_limit, range.max);
+
+  PRINT_DEBUG(1, F("Config power to %i on %s"), pw,
+              (range.config & 0x80) ? "PA_BOOST" : "RFO");
+
+  write_reg(RegPaConfig, range.config - (range.max - pw));
+  // no boost +20dB
+  write_reg(Chip::reg_pa_dac, (read_reg(Chip::reg_pa_dac) & 0xF8) | 0x4);
+}
+
+// frequency error of last LoRa packet [Hz]
+// Ferr = FreqError * 2^24 / Fxtal * BW / 500kHz
+template <class Chip>
+int32_t RadioSx127x<Chip>::read_frequency_error() {
+  uint8_t fei[3];
+  hal.read_buffer(LORARegFeiMsb, fei, sizeof(fei));
+  // 20 bits signed
+  int32_t const raw =
+      static_cast<int32_t>(static_cast<uint32_t>(fei[0]) << 28 |
+                           static_cast<uint32_t>(fei[1]) << 20 |
+                           static_cast<uint32_t>(fei[2]) << 12) >>
+      12;
+  // bandwidth from modem config
+  uint8_t const bw_index =
+      ((read_reg(LORARegModemConfig1) >> Chip::mc1_bw_shift) & 0x0F) -
+      Chip::mc1_bw_125;
+  int32_t const bw_khz = INT32_C(125) << bw_index;
+  return static_cast<int32_t>(static_cast<int64_t>(raw) * bw_khz *
+                              (INT32_C(1) << 24) / (INT64_C(32000) * 500000));
+}
+
+// LNA boost for boosted gain, AGC stays on (in RegModemConfig2 or 3).
+template <class Chip>
+uint8_t RadioSx127x<Chip>::lna_gain() const {
+  return rx_gain == RxGain::BOOSTED ? LNA_RX_GAIN : LNA_RX_GAIN_POWER_SAVING;
+}
+
+// start LoRa receiver
+template <class Chip>
+void RadioSx127x<Chip>::rxrssi() {
+  // select LoRa modem (from sleep mode)
+  opmodeLora();
+  // enter standby mode (warm up))
+  opmode(OPMODE_STANDBY);
+  // don't use MAC settings at startup
+  // use fixed settings for rssi scan
+  write_reg(LORARegModemConfig1, RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG1);
+  write_reg(LORARegModemConfig2,
+            RXLORA_RXMODE_RSSI_REG_MODEM_CONFIG2 | Chip::mc2_agc_auto);
+  // set LNA gain
+  write_reg(RegLna, LNA_RX_GAIN);
+
+  clear_irq();
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+  // now instruct the radio to receive
+  // continous rx
+  opmode(OPMODE_RX);
+  PRINT_DEBUG(1, F("RXMODE_RSSI"));
+}
+
+template <class Chip>
+OsDeltaTime RadioSx127x<Chip>::init_step() {
+  switch (init_state) {
+  case InitState::START:
+    // DIO0 (TxDone/RxDone) and DIO1 (RxTimeout) signal end of operation
+    hal.init(0x03);
+    // manually reset radio
+    // drive RST pin (low on SX1276, high on SX1272)
+    hal.pin_rst(Chip::reset_level);
+    init_state = InitState::RESET;
+    // wait >100us for SX127x to detect reset
+    return OsDeltaTime::from_ms(1);
+  case InitState::RESET:
+    // configure RST pin floating!
+    hal.pin_rst(2);
+    init_state = InitState::BOOT;
+    // wait 5ms after reset
+    return OsDeltaTime::from_ms(5);
+  case InitState::BOOT:
+    break;
+  }
+  init_state = InitState::START;
+  // all registers are back to reset value.
+  shadow_valid = 0;
+  rx_stats = RadioStats{0, 0, 0};
+
+  // some sanity checks, e.g., read version number
+  uint8_t const v = hal.read_reg(RegVersion);
+  PRINT_DEBUG(1, F("Chip version : %i"), v);
+  ASSERT(v == Chip::version);
+
+  /* TODO add a parameter
+  // Configure max curent
+  // limit current to 45mA
+  constexpr uint8_t limit = 0;
+  hal.write_reg(RegOcp, 0x20 | limit);
+  */
+  opmode(OPMODE_SLEEP);
+  return OsDeltaTime(0);
+}
+
+CONST_TABLE(uint16_t, CAD_INIT_CMD)
+[] = {
+    // set LNA gain
+    RegSet(RegLna, LNA_RX_GAIN).raw(),
+    // set sync word
+    RegSet(LORARegSyncWord, LORA_MAC_PREAMBLE).raw(),
+    // configure DIO mapping DIO0=CadDone DIO1=CadDetected DIO2=NOP
+    RegSet(RegDioMapping1,
+           MAP_DIO0_LORA_CADDONE | MAP_DIO1_LORA_CADDETD | MAP_DIO2_LORA_NOP)
+        .raw(),
+    // clear all radio IRQ flags
+    RegSet(LORARegIrqFlags, 0xFF).raw(),
+    // enable required radio IRQs
+    RegSet(LORARegIrqFlagsMask,
+           (uint8_t) ~(IRQ_LORA_CDDONE_MASK | IRQ_LORA_CDDETD_MASK))
+        .raw(),
+};
+
+constexpr uint8_t NB_CAD_INIT_CMD = sizeof(RESOLVE_TABLE(CAD_INIT_CMD)) /
+                                    sizeof(RESOLVE_TABLE(CAD_INIT_CMD)[0]);
+
+template <class Chip>
+bool RadioSx127x<Chip>::channel_activity(uint32_t const freq, rps_t const rps) {
+  // select LoRa modem (from sleep mode)
+  opmodeLora();
+  // enter standby mode (warm up))
+  opmode(OPMODE_STANDBY);
+  // configure LoRa modem (cfg1, cfg2)
+  configLoraModem(rps);
+  // configure frequency
+  configChannel(freq);
+  write_list_of_reg(RESOLVE_TABLE(CAD_INIT_CMD), NB_CAD_INIT_CMD);
+
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+  opmode(OPMODE_CAD);
+  // CAD last about 2 symbols, radio goes back to standby after.
+  bool const detected =
+      wait_cad_end(rps, 2, &HalIo::io_check0) &&
+      (hal.read_reg(LORARegIrqFlags) & IRQ_LORA_CDDETD_MASK) != 0;
+  PRINT_DEBUG(1, F("CAD freq=%" PRIu32 ", SF=%d, detected=%d"), freq,
+              rps.sf + 6, detected);
+
+  clear_irq();
+  // go from stanby to sleep
+  opmode(OPMODE_SLEEP);
+  return detected;
+}
+
+// get random seed from wideband noise rssi
+template <class Chip>
+void RadioSx127x<Chip>::init_random(uint8_t randbuf[16]) {
+  // seed randomness via noise rssi
+  rxrssi();
+  while ((hal.read_reg(RegOpMode) & OPMODE_MASK) != OPMODE_RX)
+    ; // continuous rx
+  // Only the low bit is noise. Von Neumann extractor: a pair of samples
+  // gives a bit only if they differ, this removes the bias.
+  for (uint8_t i = 0; i < 16; i++) {
+    for (uint8_t j = 0; j < 8; j++) {
+      uint8_t first;
+      uint8_t second;
+      // a stuck receiver must not hang the init, give up after 255 pairs.
+      uint8_t pairs = 0;
+      do {
+        first = hal.read_reg(LORARegRssiWideband) & 0x01;
+        second = hal.read_reg(LORARegRssiWideband) & 0x01;
+      } while (first == second && ++pairs != 0);
+      randbuf[i] = static_cast<uint8_t>((randbuf[i] << 1) | first);
+    }
+  }
+
+  // stop RX
+  opmode(OPMODE_SLEEP);
+}
+
+template <class Chip>
+int16_t RadioSx127x<Chip>::rssi() const {
+  uint8_t const r = hal.read_reg(LORARegRssiValue);
+  return Chip::rssi_offset + r;
+}
+
+template <class Chip>
+RadioStats RadioSx127x<Chip>::stats() const {
+  return rx_stats;
+}
+
+// configuration only need a few SPI transfers, oscillator start from sleep
+// is 250us.
+template <class Chip>
+OsDeltaTime RadioSx127x<Chip>::rx_rampup() const {
+  return OsDeltaTime::from_ms(3);
+}
+
+template <class Chip>
+OsDeltaTime RadioSx127x<Chip>::tx_rampup() const {
+  return OsDeltaTime::from_ms(2);
+}
+
+// RC oscillator and image are only calibrated at power on.
+template <class Chip>
+OsDeltaTime RadioSx127x<Chip>::calibration_rampup(OsTime) const {
+  return OsDeltaTime(0);
+}
+
+template <class Chip> void RadioSx127x<Chip>::start_calibration(OsTime) {}
+
+// called by hal ext IRQ handler
+// (radio goes to stanby mode after tx/rx operations)
+template <class Chip>
+uint8_t RadioSx127x<Chip>::handle_end_rx(uint8_t *const framePtr) {
+  if (modem != OPMODE_LORA) {
+    return handle_end_rx_fsk(framePtr);
+  }
+
+  uint8_t const flags = hal.read_reg(LORARegIrqFlags);
+  PRINT_DEBUG(2, F("irq: flags: 0x%x\n"), flags);
+
+  uint8_t length = 0;
+  if (flags & IRQ_LORA_RXDONE_MASK) {
+    // read the PDU and inform the MAC that we received something
+    length = hal.read_reg(LORARegRxNbBytes);
+
+    // for security clamp length of data
+    length = std::min(length, MAX_LEN_FRAME);
+
+    // set FIFO read address pointer
+    hal.write_reg(LORARegFifoAddrPtr, hal.read_reg(LORARegFifoRxCurrentAddr));
+    // now read the FIFO
+    hal.read_buffer(RegFifo, framePtr, length);
+
+    // read rx quality parameters
+    // SNR [dB] * 4
+    auto const snr = static_cast<int8_t>(hal.read_reg(LORARegPktSnrValue));
+    // RSSI [dBm]
+    int16_t rssi = Chip::rssi_offset + hal.read_reg(LORARegPktRssiValue);
+    if (snr < 0) {
+      // packet below noise floor
+      rssi += snr / 4;
+    }
+    store_packet_quality(rssi, snr);
+    store_frequency_error(read_frequency_error());
+
+    // counters are reset when entering RX.
+    // valid header without valid packet is a CRC error.
+    uint8_t const headers = hal.read_reg(LORARegRxHeaderCntValueLsb);
+    uint8_t const packets = hal.read_reg(LORARegRxpacketCntValueLsb);
+    rx_stats.received += packets;
+    if (headers > packets) {
+      rx_stats.crc_error += headers - packets;
+    }
+  } else if (flags & IRQ_LORA_RXTOUT_MASK) {
+    // indicate timeout
+    PRINT_DEBUG(1, F("RX timeout"));
+  } else {
+    // stopped by io_check(), preamble without valid header.
+    PRINT_DEBUG(1, F("RX no valid header"));
+    rx_stats.header_error++;
+  }
+  header_pending = false;
+  clear_irq();
+  // go from stanby to sleep
+  opmode(OPMODE_SLEEP);
+
+  PRINT_DEBUG(2, F("RX SPI bytes : %u"),
+              (uint16_t)(hal.spi_bytes() - spi_bytes_start));
+  // 0 in case of timeout.
+  return length;
+}
+
+template <class Chip>
+uint8_t RadioSx127x<Chip>::handle_end_rx_fsk(uint8_t *const framePtr) {
+  uint8_t const flags1 = hal.read_reg(FSKRegIrqFlags1);
+  uint8_t const flags2 = hal.read_reg(FSKRegIrqFlags2);
+  PRINT_DEBUG(2, F("irq: flags: 0x%x 0x%x\n"), flags1, flags2);
+
+  uint8_t length = 0;
+  if ((flags2 & IRQ_FSK2_PAYLOADREADY_MASK) &&
+      (flags2 & IRQ_FSK2_CRCOK_MASK)) {
+    // variable length packet, length byte first in FIFO.
+    length = std::min(hal.read_reg(RegFifo), MAX_LEN_FRAME);
+    hal.read_buffer(RegFifo, framePtr, length);
+    // RSSI [dBm] = -value / 2, no SNR in FSK
+    uint8_t const rssi_value = hal.read_reg(FSKRegRssiValue);
+    store_packet_quality(-static_cast<int16_t>(rssi_value) / 2, 0);
+    rx_stats.received++;
+  } else if (flags2 & IRQ_FSK2_PAYLOADREADY_MASK) {
+    PRINT_DEBUG(1, F("RX CRC error"));
+    rx_stats.crc_error++;
+  } else if (flags1 & IRQ_FSK1_TIMEOUT_MASK) {
+    PRINT_DEBUG(1, F("RX timeout"));
+  }
+  // flags and FIFO are cleared when leaving RX.
+  opmode(OPMODE_SLEEP);
+  return length;
+}
+
+// oscillator start from sleep is 250us, always sleep.
+template <class Chip>
+void RadioSx127x<Chip>::handle_end_tx(OsDeltaTime /* idle */) {
+  if (modem != OPMODE_LORA) {
+    // flags are cleared when leaving TX.
+    opmode(OPMODE_SLEEP);
+    return;
+  }
+  clear_irq();
+  // go from stanby to sleep
+  opmode(OPMODE_SLEEP);
+  PRINT_DEBUG(2, F("TX SPI bytes : %u"),
+              (uint16_t)(hal.spi_bytes() - spi_bytes_start));
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::clear_irq() {
+  // mask all radio IRQs
+  write_reg(LORARegIrqFlagsMask, 0xFF);
+  // clear radio IRQ flags
+  hal.write_reg(LORARegIrqFlags, 0xFF);
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::rst() {
+  // put radio to sleep
+  opmode(OPMODE_SLEEP);
+}
+
+CONST_TABLE(uint16_t, TX_INIT_CMD)
+[] = {
+    // set sync word
+    RegSet(LORARegSyncWord, LORA_MAC_PREAMBLE).raw(),
+    // 8 symbols preamble
+    RegSet(LORARegPreambleMsb, 0).raw(),
+    RegSet(LORARegPreambleLsb, 8).raw(),
+    // set the IRQ mapping DIO0=TxDone DIO1=NOP DIO2=NOP
+    RegSet(RegDioMapping1,
+           MAP_DIO0_LORA_TXDONE | MAP_DIO1_LORA_NOP | MAP_DIO2_LORA_NOP)
+        .raw(),
+    // clear all radio IRQ flags
+    RegSet(LORARegIrqFlags, 0xFF).raw(),
+    // mask all IRQs but TxDone
+    RegSet(LORARegIrqFlagsMask, ~IRQ_LORA_TXDONE_MASK).raw(),
+
+    // initialize the payload size and address pointers
+    RegSet(LORARegFifoTxBaseAddr, 0x00).raw(),
+    RegSet(LORARegFifoAddrPtr, 0x00).raw(),
+};
+
+constexpr uint8_t NB_TX_INIT_CMD =
+    sizeof(RESOLVE_TABLE(TX_INIT_CMD)) / sizeof(RESOLVE_TABLE(TX_INIT_CMD)[0]);
+
+template <class Chip>
+void RadioSx127x<Chip>::prepare_tx(uint32_t const freq, rps_t const rps,
+                                   int8_t const txpow,
+                                   uint8_t const *const framePtr,
+                                   uint8_t const frameLength) {
+  spi_bytes_start = hal.spi_bytes();
+  if (rps.sf == FSK) {
+    prepare_tx_fsk(freq, txpow, framePtr, frameLength);
+    return;
+  }
+  // select LoRa modem (from sleep mode)
+  opmodeLora();
+  // enter standby mode (required for FIFO loading))
+  opmode(OPMODE_STANDBY);
+  // configure LoRa modem (cfg1, cfg2)
+  configLoraModem(rps);
+  // configure frequency
+  configChannel(freq);
+  // configure output power
+  // set PA ramp-up time 50 uSec
+  write_reg(RegPaRamp, (read_reg(RegPaRamp) & 0xF0) | 0x08);
+  configPower(txpow);
+  // normal I/Q on TX (a raw link may have inverted it)
+  write_reg(LORARegInvertIQ, read_reg(LORARegInvertIQ) | 0x01);
+
+  write_list_of_reg(RESOLVE_TABLE(TX_INIT_CMD), NB_TX_INIT_CMD);
+
+  write_reg(LORARegPayloadLength, frameLength);
+
+  // download buffer to the radio FIFO
+  hal.write_buffer(RegFifo, framePtr, frameLength);
+
+  // enable antenna switch for TX
+  hal.pin_switch_antenna_tx(true);
+
+  // start synthesizer, TX can start without PLL lock delay.
+  opmode(OPMODE_FSTX);
+
+  PRINT_DEBUG(1, F("TXMODE, freq=%" PRIu32 ", len=%d, SF=%d, BW=%d, CR=4/%d"),
+              freq, frameLength, rps.sf + 6, bwForLog(rps), crForLog(rps));
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::start_tx() {
+  // now we actually start the transmission
+  hal.clear_edge();
+  opmode(OPMODE_TX);
+  // the radio will go back to STANDBY mode as soon as the TX is finished
+  // the corresponding IRQ will inform us about completion.
+}
+
+CONST_TABLE(uint16_t, RX_INIT_CMD)
+[] = {
+    // set max payload size
+    RegSet(LORARegPayloadMaxLength, 64).raw(),
+    // set sync word
+    RegSet(LORARegSyncWord, LORA_MAC_PREAMBLE).raw(),
+    // 8 symbols preamble
+    RegSet(LORARegPreambleMsb, 0).raw(),
+    RegSet(LORARegPreambleLsb, 8).raw(),
+    // configure DIO mapping DIO0=RxDone DIO1=RxTout DIO2=NOP
+    RegSet(RegDioMapping1,
+           MAP_DIO0_LORA_RXDONE | MAP_DIO1_LORA_RXTOUT | MAP_DIO2_LORA_NOP)
+        .raw(),
+    // clear all radio IRQ flags
+    RegSet(LORARegIrqFlags, 0xFF).raw(),
+    // enable required radio IRQs (valid header is only read)
+    RegSet(LORARegIrqFlagsMask,
+           (uint8_t) ~(IRQ_LORA_RXDONE_MASK | IRQ_LORA_RXTOUT_MASK |
+                       IRQ_LORA_HEADER_MASK))
+        .raw(),
+
+};
+
+constexpr uint8_t NB_RX_INIT_CMD =
+    sizeof(RESOLVE_TABLE(RX_INIT_CMD)) / sizeof(RESOLVE_TABLE(RX_INIT_CMD)[0]);
+
+template <class Chip>
+void RadioSx127x<Chip>::rx(uint32_t const freq, rps_t const rps,
+                           uint8_t const rxsyms, OsTime const rxtime) {
+  spi_bytes_start = hal.spi_bytes();
+  if (rps.sf == FSK) {
+    rx_fsk(freq, rxsyms, rxtime);
+    return;
+  }
+  // receive frame now (exactly at rxtime)
+  // select LoRa modem (from sleep mode)
+  opmodeLora();
+  ASSERT((hal.read_reg(RegOpMode) & OPMODE_LORA) != 0);
+  // enter standby mode (warm up))
+  opmode(OPMODE_STANDBY);
+  // don't use MAC settings at startup
+  // configure LoRa modem (cfg1, cfg2)
+  configLoraModem(rps);
+  // configure frequency
+  configChannel(freq);
+
+  // set symbol timeout (for single rx)
+  write_reg(LORARegSymbTimeoutLsb, rxsyms);
+#if !defined(DISABLE_INVERT_IQ_ON_RX)
+  // use inverted I/Q signal (prevent mote-to-mote communication)
+  write_reg(LORARegInvertIQ, read_reg(LORARegInvertIQ) | (1 << 6));
+#endif
+  write_reg(RegLna, lna_gain());
+  write_list_of_reg(RESOLVE_TABLE(RX_INIT_CMD), NB_RX_INIT_CMD);
+
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  // now instruct the radio to receive
+  // busy wait until exact rx time
+  wait_start(rxtime);
+  // single rx
+  hal.clear_edge();
+  opmode(OPMODE_RX_SINGLE);
+  // ValidHeader is on DIO3 (not wired): check flag once when the header
+  // should have been received.
+  header_deadline =
+      rxtime + OsDeltaTime::from_us((rxsyms + HEADER_END_SYMBOLS) *
+                                    symbol_time_us(rps));
+  header_pending = true;
+
+  PRINT_DEBUG(
+      1, F("RXMODE_SINGLE, freq=%" PRIu32 ", SF=%d, BW=%d, CR=4/%d, IH=%d"),
+      freq, rps.sf + 6, bwForLog(rps), crForLog(rps));
+  // the radio will go back to STANDBY mode as soon as the RX is finished
+  // or timed out, and the corresponding IRQ will inform us about completion.
+}
+
+// LoRaWAN FSK: 50kbps, +/-25kHz deviation, 5 bytes preamble,
+// 3 bytes sync word C194C1, variable length, whitening, CRC.
+CONST_TABLE(uint16_t, FSK_INIT_CMD)
+[] = {
+    // bitrate 50kbps
+    RegSet(FSKRegBitrateMsb, 0x02).raw(),
+    RegSet(FSKRegBitrateLsb, 0x80).raw(),
+    // frequency deviation +/- 25kHz
+    RegSet(FSKRegFdevMsb, 0x01).raw(),
+    RegSet(FSKRegFdevLsb, 0x99).raw(),
+    RegSet(FSKRegPreambleMsb, 0x00).raw(),
+    RegSet(FSKRegPreambleLsb, 0x05).raw(),
+    // preamble 0xAA, 3 bytes sync word
+    RegSet(FSKRegSyncConfig, 0x12).raw(),
+    RegSet(FSKRegSyncValue1, 0xC1).raw(),
+    RegSet(FSKRegSyncValue2, 0x94).raw(),
+    RegSet(FSKRegSyncValue3, 0xC1).raw(),
+    // variable length, whitening, crc, no crc auto clear, no address filter
+    RegSet(FSKRegPacketConfig1, 0xD8).raw(),
+    // packet mode
+    RegSet(FSKRegPacketConfig2, 0x40).raw(),
+};
+
+constexpr uint8_t NB_FSK_INIT_CMD = sizeof(RESOLVE_TABLE(FSK_INIT_CMD)) /
+                                    sizeof(RESOLVE_TABLE(FSK_INIT_CMD)[0]);
+
+CONST_TABLE(uint16_t, FSK_RX_INIT_CMD)
+[] = {
+    // AFC auto, AGC, trigger on preamble
+    RegSet(FSKRegRxConfig, 0x1E).raw(),
+    // receiver bandwidth 50kHz SSB
+    RegSet(FSKRegRxBw, 0x0B).raw(),
+    // AFC bandwidth 83.3kHz SSB
+    RegSet(FSKRegAfcBw, 0x12).raw(),
+    // preamble detection enable, 2 bytes, 10 chip errors
+    RegSet(FSKRegPreambleDetect, 0xAA).raw(),
+    // max payload size
+    RegSet(FSKRegPayloadLength, MAX_LEN_FRAME).raw(),
+    // configure DIO mapping DIO0=PayloadReady DIO1=NOP DIO2=TimeOut
+    RegSet(RegDioMapping1,
+           MAP_DIO0_FSK_READY | MAP_DIO1_FSK_NOP | MAP_DIO2_FSK_TIMEOUT)
+        .raw(),
+};
+
+constexpr uint8_t NB_FSK_RX_INIT_CMD =
+    sizeof(RESOLVE_TABLE(FSK_RX_INIT_CMD)) /
+    sizeof(RESOLVE_TABLE(FSK_RX_INIT_CMD)[0]);
+
+template <class Chip>
+void RadioSx127x<Chip>::prepare_tx_fsk(uint32_t const freq, int8_t const txpow,
+                                       uint8_t const *const framePtr,
+                                       uint8_t const frameLength) {
+  // select FSK modem (from sleep mode)
+  opmodeFsk();
+  // enter standby mode (required for FIFO loading))
+  opmode(OPMODE_STANDBY);
+  write_list_of_reg(RESOLVE_TABLE(FSK_INIT_CMD), NB_FSK_INIT_CMD);
+  configChannel(freq);
+  // gaussian shaping (SX1276) and ramp-up time 50 uSec
+  write_reg(RegPaRamp, (read_reg(RegPaRamp) & 0x90) |
+                           Chip::pa_ramp_fsk_shaping | 0x08);
+  configPower(txpow);
+  // set the IRQ mapping DIO0=PacketSent DIO1=NOP DIO2=NOP
+  write_reg(RegDioMapping1,
+            MAP_DIO0_FSK_READY | MAP_DIO1_FSK_NOP | MAP_DIO2_FSK_TXNOP);
+
+  // download length byte and buffer to the radio FIFO
+  hal.write_reg(RegFifo, frameLength);
+  hal.write_buffer(RegFifo, framePtr, frameLength);
+
+  // enable antenna switch for TX
+  hal.pin_switch_antenna_tx(true);
+  // start synthesizer, TX can start without PLL lock delay.
+  opmode(OPMODE_FSTX);
+
+  PRINT_DEBUG(1, F("TXMODE FSK, freq=%" PRIu32 ", len=%d"), freq,
+              frameLength);
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::rx_fsk(uint32_t const freq, uint8_t const rxsyms,
+                               OsTime const rxtime) {
+  // select FSK modem (from sleep mode)
+  opmodeFsk();
+  // enter standby mode (warm up))
+  opmode(OPMODE_STANDBY);
+  write_list_of_reg(RESOLVE_TABLE(FSK_INIT_CMD), NB_FSK_INIT_CMD);
+  configChannel(freq);
+  write_reg(RegLna, lna_gain());
+  write_list_of_reg(RESOLVE_TABLE(FSK_RX_INIT_CMD), NB_FSK_RX_INIT_CMD);
+  // preamble timeout, unit is 16 bits (rxsyms in bytes) plus preamble
+  // detection (2 bytes).
+  hal.write_reg(FSKRegRxTimeout2, std::min(rxsyms / 2 + 2, 255));
+
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  // now instruct the radio to receive
+  // busy wait until exact rx time
+  wait_start(rxtime);
+  // no single rx mode available in FSK
+  hal.clear_edge();
+  opmode(OPMODE_RX);
+
+  PRINT_DEBUG(1, F("RXMODE FSK, freq=%" PRIu32 ", rxsyms=%d"), freq, rxsyms);
+}
+
+// No autonomous RX duty cycle on SX127x, listen continuously.
+template <class Chip>
+void RadioSx127x<Chip>::rx_sniff(uint32_t const freq, rps_t const rps,
+                                 uint16_t /* preamble_syms */) {
+  spi_bytes_start = hal.spi_bytes();
+  // select LoRa modem (from sleep mode)
+  opmodeLora();
+  // enter standby mode (warm up))
+  opmode(OPMODE_STANDBY);
+  // configure LoRa modem (cfg1, cfg2)
+  configLoraModem(rps);
+  // configure frequency
+  configChannel(freq);
+#if !defined(DISABLE_INVERT_IQ_ON_RX)
+  // use inverted I/Q signal (prevent mote-to-mote communication)
+  write_reg(LORARegInvertIQ, read_reg(LORARegInvertIQ) | (1 << 6));
+#endif
+  write_reg(RegLna, lna_gain());
+  write_list_of_reg(RESOLVE_TABLE(RX_INIT_CMD), NB_RX_INIT_CMD);
+
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  // continous rx
+  hal.clear_edge();
+  opmode(OPMODE_RX);
+
+  PRINT_DEBUG(1, F("RXMODE_CONTINUOUS, freq=%" PRIu32 ", SF=%d, BW=%d"), freq,
+              rps.sf + 6, bwForLog(rps));
+}
+
+// common settings of raw LoRa TX and RX.
+template <class Chip>
+void RadioSx127x<Chip>::config_raw(uint32_t const freq,
+                                   RawLoraConfig const &config) {
+  spi_bytes_start = hal.spi_bytes();
+  // select LoRa modem (from sleep mode)
+  opmodeLora();
+  // enter standby mode (required for FIFO loading))
+  opmode(OPMODE_STANDBY);
+  configLoraModem(config.rps, config.implicit_length != 0);
+  configChannel(freq);
+  write_reg(LORARegSyncWord, config.sync_word);
+  uint8_t const preamble[2] = {static_cast<uint8_t>(config.preamble >> 8),
+                               static_cast<uint8_t>(config.preamble)};
+  write_regs(LORARegPreambleMsb, preamble, sizeof(preamble));
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::tx_raw(uint32_t const freq,
+                               RawLoraConfig const &config, int8_t const txpow,
+                               uint8_t const *const framePtr,
+                               uint8_t const frameLength) {
+  config_raw(freq, config);
+  // set PA ramp-up time 50 uSec
+  write_reg(RegPaRamp, (read_reg(RegPaRamp) & 0xF0) | 0x08);
+  configPower(txpow);
+  // I/Q on TX: bit 0 set for normal, clear for inverted
+  uint8_t const iq = read_reg(LORARegInvertIQ) & ~0x01;
+  write_reg(LORARegInvertIQ, config.invert_iq ? iq : iq | 0x01);
+  // DIO0=TxDone, FIFO from address 0
+  write_reg(RegDioMapping1,
+            MAP_DIO0_LORA_TXDONE | MAP_DIO1_LORA_NOP | MAP_DIO2_LORA_NOP);
+  write_reg(LORARegIrqFlagsMask, ~IRQ_LORA_TXDONE_MASK);
+  hal.write_reg(LORARegIrqFlags, 0xFF);
+  write_reg(LORARegFifoTxBaseAddr, 0x00);
+  hal.write_reg(LORARegFifoAddrPtr, 0x00);
+  write_reg(LORARegPayloadLength, frameLength);
+  hal.write_buffer(RegFifo, framePtr, frameLength);
+
+  // enable antenna switch for TX
+  hal.pin_switch_antenna_tx(true);
+  hal.clear_edge();
+  opmode(OPMODE_TX);
+  PRINT_DEBUG(1, F("TXMODE RAW, freq=%" PRIu32 ", len=%d, SF=%d"), freq,
+              frameLength, config.rps.sf + 6);
+}
+
+template <class Chip>
+void RadioSx127x<Chip>::rx_raw(uint32_t const freq,
+                               RawLoraConfig const &config) {
+  config_raw(freq, config);
+  write_reg(RegLna, lna_gain());
+  // I/Q on RX: bit 6 set for inverted
+  uint8_t const iq = read_reg(LORARegInvertIQ) & ~(1 << 6);
+  write_reg(LORARegInvertIQ, config.invert_iq ? iq | (1 << 6) : iq);
+  // fixed length with implicit header, any length up to 255 otherwise.
+  write_reg(LORARegPayloadMaxLength, MAX_LEN_RAW_FRAME);
+  if (config.implicit_length != 0) {
+    write_reg(LORARegPayloadLength, config.implicit_length);
+  }
+  // DIO0=RxDone, CRC error is read with RxDone
+  write_reg(RegDioMapping1,
+            MAP_DIO0_LORA_RXDONE | MAP_DIO1_LORA_NOP | MAP_DIO2_LORA_NOP);
+  write_reg(LORARegIrqFlagsMask,
+            (uint8_t) ~(IRQ_LORA_RXDONE_MASK | IRQ_LORA_CRCERR_MASK));
+  hal.write_reg(LORARegIrqFlags, 0xFF);
+
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+  // continous rx, each frame is stored at the same FIFO address.
+  hal.clear_edge();
+  opmode(OPMODE_RX);
+  PRINT_DEBUG(1, F("RXMODE RAW, freq=%" PRIu32 ", SF=%d"), freq,
+              config.rps.sf + 6);
+}
+
+template <class Chip>
+uint8_t RadioSx127x<Chip>::read_raw(uint8_t *const framePtr) {
+  uint8_t const flags = hal.read_reg(LORARegIrqFlags);
+
+  uint8_t length = 0;
+  if (flags & IRQ_LORA_CRCERR_MASK) {
+    PRINT_DEBUG(1, F("RX CRC error"));
+    rx_stats.crc_error++;
+  } else if (flags & IRQ_LORA_RXDONE_MASK) {
+    length = hal.read_reg(LORARegRxNbBytes);
+    hal.write_reg(LORARegFifoAddrPtr, hal.read_reg(LORARegFifoRxCurrentAddr));
+    hal.read_buffer(RegFifo, framePtr, length);
+
+    auto const snr = static_cast<int8_t>(hal.read_reg(LORARegPktSnrValue));
+    int16_t rssi = Chip::rssi_offset + hal.read_reg(LORARegPktRssiValue);
+    if (snr < 0) {
+      rssi += snr / 4;
+    }
+    store_packet_quality(rssi, snr);
+    store_frequency_error(read_frequency_error());
+    rx_stats.received++;
+  }
+  // radio stay in RX, next frame will raise DIO0 again.
+  hal.write_reg(LORARegIrqFlags, 0xFF);
+  return length;
+}
+
+/**
+ * Check the IO pin.
+ * Return true if the radio has finish it's operation
+ */
+template <class Chip>
+bool RadioSx127x<Chip>::io_check() const {
+  if (hal.io_check()) {
+    return true;
+  }
+  if (header_pending) {
+    return header_missing();
+  }
+  // FSK RX timeout is only on DIO2, read it.
+  return modem != OPMODE_LORA &&
+         (hal.read_reg(FSKRegIrqFlags1) & IRQ_FSK1_TIMEOUT_MASK);
+}
+
+// Preamble detected but no valid header, the frame can't be for us.
+// Return true to stop RX early (one register read by RX window).
+template <class Chip>
+bool RadioSx127x<Chip>::header_missing() const {
+  if (os_getTime() < header_deadline) {
+    return false;
+  }
+  header_pending = false;
+  return (hal.read_reg(LORARegIrqFlags) & IRQ_LORA_HEADER_MASK) == 0;
+}
+
+template <class Chip>
+RadioSx127x<Chip>::RadioSx127x(lmic_pinmap const &pins) : Radio(pins) {
+  static_assert(shadow_index(Chip::reg_pa_dac, Chip::reg_pa_dac) <
+                    NB_SHADOW_REG,
+                "Shadow register array too small");
+}
+
+// unused driver is removed by the linker (one section by function).
+template class RadioSx127x<Sx1272Chip>;
+template class RadioSx127x<Sx1276Chip>;
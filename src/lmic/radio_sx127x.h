@@ -0,0 +1,166 @@
+/*******************************************************************************
+ * Copyright (c) 2014-2015 IBM Corporation.
+ * All rights reserved. This program and the accompanying materials
+ * are made available under the terms of the Eclipse Public License v1.0
+ * which accompanies this distribution, and is available at
+ * http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Contributors:
+ *    IBM Zurich Research Lab - initial API, implementation and documentation
+ *    Nicolas Graziano - cpp style.
+ *******************************************************************************/
+
+#ifndef _radio_sx127x_h_
+#define _radio_sx127x_h_
+
+#include "lorabase.h"
+#include "osticks.h"
+#include "radio.h"
+#include <stdint.h>
+
+struct RegSet {
+  const uint8_t reg;
+  const uint8_t val;
+
+  constexpr uint16_t raw() const { return reg << 8 | val; };
+  constexpr RegSet(uint8_t areg, uint8_t aval) : reg(areg), val(aval){};
+  constexpr RegSet(uint16_t raw) : reg(raw >> 8), val(raw & 0xFF){};
+};
+
+/**
+ * SX1276 specific constants.
+ * SX1272 and SX1276 share registers, only a few bits and values move.
+ */
+struct Sx1276Chip {
+  // RegVersion value
+  static constexpr uint8_t version = 0x12;
+  static constexpr uint8_t reg_pa_dac = 0x4D;
+  // RST pin level to reset the chip
+  static constexpr uint8_t reset_level = 0;
+  // RSSI [dBm] = rssi_offset + register (high frequency port)
+  static constexpr int16_t rssi_offset = -157;
+  // RegModemConfig1 : value of BW 125kHz and bit position of BW and CR
+  static constexpr uint8_t mc1_bw_125 = 7;
+  static constexpr uint8_t mc1_bw_shift = 4;
+  static constexpr uint8_t mc1_cr_shift = 1;
+  static constexpr uint8_t mc1_crc_on = 0x00;
+  static constexpr uint8_t mc1_low_data_rate = 0x00;
+  static constexpr uint8_t mc1_implicit_header = 0x01;
+  // RegModemConfig2
+  static constexpr uint8_t mc2_crc_on = 0x04;
+  static constexpr uint8_t mc2_agc_auto = 0x00;
+  // AGC and low data rate optimize are in RegModemConfig3
+  static constexpr bool has_mc3 = true;
+  // FSK gaussian filter BT=0.5 is in RegPaRamp
+  static constexpr uint8_t opmode_fsk_shaping = 0x00;
+  static constexpr uint8_t pa_ramp_fsk_shaping = 0x40;
+  // RFO {max power dBm, RegPaConfig at max power} for low and high power,
+  // Pout = Pmax - (15 - OutputPower): MaxPower=0 (Pmax=10.8dBm) and
+  // MaxPower=7 (Pmax=15dBm).
+  static constexpr int8_t rfo_low_max = -1;
+  static constexpr uint8_t rfo_low_config = 0x03;
+  static constexpr int8_t rfo_high_max = 15;
+  static constexpr uint8_t rfo_high_config = 0x7F;
+};
+
+/**
+ * SX1272 specific constants.
+ */
+struct Sx1272Chip {
+  static constexpr uint8_t version = 0x22;
+  static constexpr uint8_t reg_pa_dac = 0x5A;
+  static constexpr uint8_t reset_level = 1;
+  static constexpr int16_t rssi_offset = -139;
+  static constexpr uint8_t mc1_bw_125 = 0;
+  static constexpr uint8_t mc1_bw_shift = 6;
+  static constexpr uint8_t mc1_cr_shift = 3;
+  static constexpr uint8_t mc1_crc_on = 0x02;
+  static constexpr uint8_t mc1_low_data_rate = 0x01;
+  static constexpr uint8_t mc1_implicit_header = 0x04;
+  static constexpr uint8_t mc2_crc_on = 0x00;
+  static constexpr uint8_t mc2_agc_auto = 0x04;
+  static constexpr bool has_mc3 = false;
+  // FSK gaussian filter BT=0.5 is in RegOpMode
+  static constexpr uint8_t opmode_fsk_shaping = 0x10;
+  static constexpr uint8_t pa_ramp_fsk_shaping = 0x00;
+  // RFO has no MaxPower: Pout = -1 + OutputPower, a single range.
+  static constexpr int8_t rfo_low_max = 14;
+  static constexpr uint8_t rfo_low_config = 0x0F;
+  static constexpr int8_t rfo_high_max = 14;
+  static constexpr uint8_t rfo_high_config = 0x0F;
+};
+
+/**
+ * Driver of SX1272 / SX1276, chip differences are resolved at compile time.
+ */
+template <class Chip> class RadioSx127x final : public Radio {
+
+public:
+  explicit RadioSx127x(lmic_pinmap const &pins);
+  OsDeltaTime init_step() RADIO_FINAL;
+  void rst() RADIO_FINAL;
+  void prepare_tx(uint32_t freq, rps_t rps, int8_t txpow,
+                  uint8_t const *framePtr, uint8_t frameLength) RADIO_FINAL;
+  void start_tx() RADIO_FINAL;
+  void rx(uint32_t freq, rps_t rps, uint8_t rxsyms, OsTime rxtime) RADIO_FINAL;
+
+  bool channel_activity(uint32_t freq, rps_t rps) RADIO_FINAL;
+  void rx_sniff(uint32_t freq, rps_t rps, uint16_t preamble_syms) RADIO_FINAL;
+  void tx_raw(uint32_t freq, RawLoraConfig const &config, int8_t txpow,
+              uint8_t const *framePtr, uint8_t frameLength) RADIO_FINAL;
+  void rx_raw(uint32_t freq, RawLoraConfig const &config) RADIO_FINAL;
+  uint8_t read_raw(uint8_t *framePtr) RADIO_FINAL;
+  void init_random(uint8_t randbuf[16]) RADIO_FINAL;
+  uint8_t handle_end_rx(uint8_t *framePtr) RADIO_FINAL;
+  void handle_end_tx(OsDeltaTime idle) RADIO_FINAL;
+  bool io_check() const RADIO_FINAL;
+
+  int16_t rssi() const RADIO_FINAL;
+  RadioStats stats() const RADIO_FINAL;
+  OsDeltaTime rx_rampup() const RADIO_FINAL;
+  OsDeltaTime tx_rampup() const RADIO_FINAL;
+  OsDeltaTime calibration_rampup(OsTime time) const RADIO_FINAL;
+  void start_calibration(OsTime time) RADIO_FINAL;
+
+private:
+  // copy of configuration registers to avoid writing unchanged values.
+  static constexpr uint8_t NB_SHADOW_REG = 22;
+  uint8_t shadow_reg[NB_SHADOW_REG];
+  // one bit by shadow register, set when the copy is known.
+  uint32_t shadow_valid = 0;
+  RadioStats rx_stats = {0, 0, 0};
+  // SPI counter at start of operation (debug).
+  uint16_t spi_bytes_start = 0;
+  // current modem bits of RegOpMode (LoRa or FSK)
+  uint8_t modem = 0x80;
+  // RX is stopped if no valid header is received before this time.
+  OsTime header_deadline;
+  mutable bool header_pending = false;
+
+  void opmode(uint8_t mode);
+  void opmodeLora();
+  void opmodeFsk();
+  void prepare_tx_fsk(uint32_t freq, int8_t txpow, uint8_t const *framePtr,
+                      uint8_t frameLength);
+  void rx_fsk(uint32_t freq, uint8_t rxsyms, OsTime rxtime);
+  uint8_t handle_end_rx_fsk(uint8_t *framePtr);
+  void configLoraModem(rps_t rps, bool implicit_header = false);
+  void config_raw(uint32_t freq, RawLoraConfig const &config);
+  void configChannel(uint32_t freq);
+  void configPower(int8_t pw);
+  void rxrssi();
+  int32_t read_frequency_error();
+  uint8_t lna_gain() const;
+  void clear_irq();
+  bool header_missing() const;
+  void write_list_of_reg(uint16_t const *listcmd, uint8_t nb_cmd);
+
+  void write_reg(uint8_t addr, uint8_t data);
+  void write_regs(uint8_t addr, uint8_t const *data, uint8_t len);
+  uint8_t read_reg(uint8_t addr);
+  uint8_t shadow_slot(uint8_t addr) const;
+  bool shadow_match(uint8_t addr, uint8_t data) const;
+  void shadow_store(uint8_t addr, uint8_t data);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,758 @@
+/*******************************************************************************
+
+ *******************************************************************************/
+
+#include "radio_sx1280.h"
+#include "../hal/print_debug.h"
+
+#include "bufferpack.h"
+#include "lmic_table.h"
+#include "radio_sx12xx_cmd.h"
+
+#include <algorithm>
+
+namespace {
+
+enum RadioCommand : uint8_t {
+  GetIrqStatus = 0x15,
+  GetRxBufferStatus = 0x17,
+  WriteRegister = 0x18,
+  ReadRegister = 0x19,
+  WriteBuffer = 0x1A,
+  ReadBuffer = 0x1B,
+  GetPacketStatus = 0x1D,
+  GetRssiInst = 0x1F,
+  SetStandby = 0x80,
+  SetRx = 0x82,
+  SetTx = 0x83,
+  SetSleep = 0x84,
+  SetRfFrequency = 0x86,
+  SetCadParams = 0x88,
+  SetPacketType = 0x8A,
+  SetModulationParams = 0x8B,
+  SetPacketParams = 0x8C,
+  SetDioIrqParams = 0x8D,
+  SetTxParams = 0x8E,
+  SetBufferBaseAddress = 0x8F,
+  SetRxDutyCycle = 0x94,
+  SetRegulatorMode = 0x96,
+  ClrIrqStatus = 0x97,
+  GetStatus = 0xC0,
+  SetFs = 0xC1,
+  SetCad = 0xC5,
+};
+
+// IRQ bits (same for all DIO)
+constexpr uint16_t TxDone = 1 << 0;
+constexpr uint16_t RxDone = 1 << 1;
+constexpr uint16_t HeaderError = 1 << 5;
+constexpr uint16_t CrcError = 1 << 6;
+constexpr uint16_t CadDone = 1 << 12;
+constexpr uint16_t CadDetected = 1 << 13;
+constexpr uint16_t RxTxTimeout = 1 << 14;
+
+void print_status(uint8_t status) {
+  PRINT_DEBUG(1, F("Status %x mode : %x, status %x"), status, (status >> 5) & 7,
+              (status >> 2) & 7);
+}
+
+template <int parameter_length>
+using Sx1280Command = sx12xx::Command<RadioCommand, parameter_length>;
+template <int length>
+using Sx1280Command_P = sx12xx::Command_P<RadioCommand, length>;
+template <int data_length>
+using Sx1280Register = sx12xx::Register<RadioCommand, data_length>;
+
+using sx12xx::command_changed;
+using sx12xx::read_command;
+using sx12xx::send_command;
+using sx12xx::wait_ready;
+using sx12xx::write_register;
+
+// frequency in PLL steps (52MHz / 2^18)
+uint32_t rf_frequency_steps(uint32_t const freq) {
+  return (((uint64_t)freq << 18) / 52000000);
+}
+
+constexpr uint8_t sf_to_parameter(sf_t sf) {
+  // SF7 => 0x70, SF8 => 0x80 ...
+  return (7 - SF7 + sf) << 4;
+}
+
+constexpr uint8_t cr_to_parameter(CodingRate cr) {
+  // CR_4_5 => 0x01, CR_4_6 => 0x02 ...
+  return (0x01 - static_cast<uint8_t>(CodingRate::CR_4_5) +
+          static_cast<uint8_t>(cr));
+}
+
+constexpr uint8_t crForLog(rps_t const rps) {
+  return (5 - static_cast<uint8_t>(CodingRate::CR_4_5) +
+          static_cast<uint8_t>(rps.getCr()));
+}
+
+/**
+ * Preamble length in symbols as mantissa (low nibble) and exponent
+ * (high nibble): mant * 2^exp, rounded up.
+ */
+uint8_t preamble_parameter(uint16_t preamble) {
+  uint8_t exponent = 0;
+  while (preamble > 15) {
+    preamble = (preamble + 1) / 2;
+    exponent++;
+  }
+  return static_cast<uint8_t>(exponent << 4) | static_cast<uint8_t>(preamble);
+}
+
+/**
+ * Step of timeout and duty cycle periods: 15.625us, 62.5us, 1ms, 4ms, with
+ * at most 0xFFFF steps.
+ */
+uint8_t period_base(uint32_t const us) {
+  if (us < 1000000) {
+    return 0x00;
+  }
+  if (us < 4000000) {
+    return 0x01;
+  }
+  if (us < 65000000) {
+    return 0x02;
+  }
+  return 0x03;
+}
+
+uint16_t period_count(uint8_t const base, uint32_t const us) {
+  uint32_t count;
+  if (base == 0x00) {
+    count = us * 64 / 1000;
+  } else if (base == 0x01) {
+    count = us * 16 / 1000;
+  } else if (base == 0x02) {
+    count = us / 1000;
+  } else {
+    count = us / 4000;
+  }
+  return static_cast<uint16_t>(std::min<uint32_t>(count, 0xFFFF));
+}
+
+// CAD number of symbols: 2 (SF7-SF8), 4 (SF9-SF12)
+constexpr uint8_t cad_symbols_parameter(sf_t const sf) {
+  return sf <= SF8 ? 0x20 : 0x40;
+}
+
+// time to wake up from warm sleep and lock PLL before listening (us)
+constexpr uint32_t SNIFF_WAKEUP_US = 1000;
+// listen at least this number of symbols to detect a preamble
+constexpr uint8_t SNIFF_RX_SYMBOLS = 2;
+
+constexpr uint8_t PACKET_TYPE_LORA = 0x01;
+
+// LoRa sync word register, LoRaWAN 2.4GHz value
+constexpr uint16_t REG_LORA_SYNC_WORD = 0x944;
+constexpr uint8_t LORA_MAC_SYNC_WORD = 0x21;
+
+// registers to set after each modulation change (datasheet 14.4.1)
+constexpr uint16_t REG_SF_ADDITIONAL_CONFIG = 0x925;
+constexpr uint16_t REG_FREQ_ERROR_CORRECTION = 0x93C;
+
+namespace cmds {
+
+/**
+ * Command to change to FS mode
+ */
+constexpr Sx1280Command_P<0> set_fs PROGMEM =
+    Sx1280Command<0>{RadioCommand::SetFs};
+
+/**
+ * Command to start TX (timeout 10s)
+ * Step 1ms => 0x02, 10000 => 0x2710
+ */
+constexpr Sx1280Command_P<3> set_tx_10s PROGMEM =
+    Sx1280Command<3>{RadioCommand::SetTx, {0x02, 0x27, 0x10}};
+
+/**
+ * Command to start RX (no timeout)
+ */
+constexpr Sx1280Command_P<3> set_rx_continious PROGMEM =
+    Sx1280Command<3>{RadioCommand::SetRx, {0x00, 0xFF, 0xFF}};
+
+/**
+ * Command to start channel activity detection
+ */
+constexpr Sx1280Command_P<0> set_cad PROGMEM =
+    Sx1280Command<0>{RadioCommand::SetCad};
+
+constexpr Sx1280Command_P<1> set_sleep_cold_start PROGMEM =
+    Sx1280Command<1>{RadioCommand::SetSleep, {0x00}};
+
+/**
+ * Sleep with configuration retention
+ */
+constexpr Sx1280Command_P<1> set_sleep_warm_start PROGMEM =
+    Sx1280Command<1>{RadioCommand::SetSleep, {0x01}};
+
+constexpr Sx1280Command_P<2> clear_all_irq PROGMEM =
+    Sx1280Command<2>{RadioCommand::ClrIrqStatus, {0xFF, 0xFF}};
+
+/**
+ * Regulator mode to DCDC
+ */
+constexpr Sx1280Command_P<1> set_regulator_mode_dcdc PROGMEM =
+    Sx1280Command<1>{RadioCommand::SetRegulatorMode, {0x01}};
+
+constexpr Sx1280Command_P<1> set_packet_type_lora PROGMEM =
+    Sx1280Command<1>{RadioCommand::SetPacketType, {PACKET_TYPE_LORA}};
+
+constexpr Sx1280Command_P<2> set_buffer_base_address PROGMEM =
+    Sx1280Command<2>{RadioCommand::SetBufferBaseAddress, {0x00, 0x00}};
+
+} // namespace cmds
+
+} // namespace
+
+OsDeltaTime RadioSx1280::init_step() {
+  switch (init_state) {
+  case InitState::START:
+    PRINT_DEBUG(1, F("Radio Init"));
+    // DIO1 is the irq pin, DIO0 is busy
+    hal.init(0x02, true);
+    // manually reset radio
+    // drive RST pin low
+    hal.pin_rst(0);
+    init_state = InitState::RESET;
+    // wait >50us for SX1280 to detect reset
+    return OsDeltaTime::from_ms(1);
+  case InitState::RESET:
+    // configure RST pin floating
+    hal.pin_rst(2);
+    init_state = InitState::BOOT;
+    // wait 5ms after reset
+    return OsDeltaTime::from_ms(5);
+  case InitState::BOOT:
+    // busy until the chip has booted, come back later instead of waiting.
+    if (hal.io_check0()) {
+      return OsDeltaTime::from_ms(1);
+    }
+    break;
+  }
+  init_state = InitState::START;
+
+  if (IS_DEBUG_ENABLE(2)) {
+    print_status(get_status());
+  }
+
+  // go to sleep without saving state
+  set_sleep(false);
+  return OsDeltaTime(0);
+}
+
+// get random seed from wideband noise rssi
+void RadioSx1280::init_random(uint8_t randbuf[16]) {
+  PRINT_DEBUG(1, F("Init random"));
+
+  init_config();
+  set_rx_continious();
+  hal_wait(OsDeltaTime::from_ms(1));
+
+  // Each byte get 8 samples, rotated to spread them. Only the low bits are
+  // noise and close samples are correlated, so the seed hold far less than
+  // 128 bits of entropy: AES in LmicRand hides the bias but adds nothing.
+  for (uint8_t i = 0; i < 128; i++) {
+    uint8_t &r = randbuf[i & 15];
+    r = static_cast<uint8_t>((r << 1) | (r >> 7)) ^ get_rssi_inst();
+  }
+  set_standby(false);
+  set_sleep(true);
+}
+
+int16_t RadioSx1280::rssi() const {
+  // RSSI [dBm] = -RssiInst / 2
+  return -static_cast<int16_t>(get_rssi_inst()) / 2;
+}
+
+RadioStats RadioSx1280::stats() const { return rx_stats; }
+
+// wake up from sleep with retention (~1.2ms) and configuration.
+OsDeltaTime RadioSx1280::rx_rampup() const { return OsDeltaTime::from_ms(3); }
+
+OsDeltaTime RadioSx1280::tx_rampup() const { return OsDeltaTime::from_ms(3); }
+
+// no calibration command is sent by this driver.
+OsDeltaTime RadioSx1280::calibration_rampup(OsTime) const {
+  return OsDeltaTime(0);
+}
+
+void RadioSx1280::start_calibration(OsTime) {}
+
+// called by hal ext IRQ handler
+// (radio goes to stanby mode after tx/rx operations)
+uint8_t RadioSx1280::handle_end_rx(uint8_t *const framePtr) {
+  uint16_t const flags = get_irq_status();
+
+  uint8_t length = 0;
+  if (flags & HeaderError) {
+    // frame can't be for us, stop now.
+    PRINT_DEBUG(1, F("RX header error"));
+    rx_stats.header_error++;
+  } else if (flags & CrcError) {
+    PRINT_DEBUG(1, F("RX CRC error"));
+    rx_stats.crc_error++;
+  } else if (flags & RxDone) {
+    rx_stats.received++;
+    // read message length
+    length = read_frame(framePtr, MAX_LEN_FRAME);
+    // read rx quality parameters
+    read_packet_status();
+  } else if (flags & RxTxTimeout) {
+    // indicate timeout
+    PRINT_DEBUG(1, F("RX timeout"));
+  }
+
+  // no interrupt
+  set_dio1_irq_params(0x00);
+  clear_all_irq();
+
+  set_sleep(true);
+  return length;
+}
+
+// no TCXO start on wake up, always sleep.
+void RadioSx1280::handle_end_tx(OsDeltaTime /* idle */) {
+  // no interrupt
+  set_dio1_irq_params(0x00);
+  clear_all_irq();
+
+  set_sleep(true);
+}
+
+void RadioSx1280::rst() {
+  // go to sleep without saving state
+  set_sleep(false);
+}
+
+void RadioSx1280::prepare_tx(uint32_t const freq, rps_t const rps,
+                             int8_t const txpow, uint8_t const *const framePtr,
+                             uint8_t const frameLength) {
+  // only LoRa on 2.4GHz
+  ASSERT(rps.sf != FSK);
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(rps);
+  set_packet_params_lora(rps, frameLength, false);
+  set_sync_word_lora(LORA_MAC_SYNC_WORD);
+  set_tx_power(txpow);
+  // enable antenna switch for TX
+  hal.pin_switch_antenna_tx(true);
+
+  write_frame(framePtr, frameLength);
+  clear_all_irq();
+  set_dio1_irq_params(TxDone | RxTxTimeout);
+  // start synthesizer, TX can start without PLL lock delay.
+  set_fs();
+
+  PRINT_DEBUG(1, F("TXMODE, freq=%" PRIu32 ", len=%d, SF=%d, BW=812, CR=4/%d"),
+              freq, frameLength, rps.sf + 6, crForLog(rps));
+}
+
+void RadioSx1280::start_tx() {
+  hal.clear_edge();
+  set_tx();
+  print_status(get_status());
+}
+
+void RadioSx1280::rx(uint32_t const freq, rps_t const rps, uint8_t const rxsyms,
+                     OsTime const rxtime) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(rps);
+  set_packet_params_lora(rps, MAX_LEN_FRAME, true);
+  set_sync_word_lora(LORA_MAC_SYNC_WORD);
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  set_dio1_irq_params(RxDone | HeaderError | CrcError | RxTxTimeout);
+  clear_all_irq();
+
+  // No symbol timeout on this chip: stop RX after the time to receive the
+  // header of a frame starting in the window.
+  uint32_t const timeout_us =
+      (rxsyms + HEADER_END_SYMBOLS) * symbol_time_us(rps);
+
+  // ramp up
+  set_fs();
+  // now instruct the radio to receive
+  // busy wait until exact rx time
+  if (rxtime < os_getTime()) {
+    PRINT_DEBUG(1, F("RX LATE :  %" PRIu32 " WANTED, late %" PRIi32 " ms"),
+                rxtime, (os_getTime() - rxtime).to_ms());
+  }
+  wait_start(rxtime);
+  hal.clear_edge();
+  set_rx(timeout_us);
+}
+
+bool RadioSx1280::channel_activity(uint32_t const freq, rps_t const rps) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(rps);
+  send_command(hal, Sx1280Command<1>{RadioCommand::SetCadParams,
+                                     {cad_symbols_parameter(rps.sf)}});
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  set_dio1_irq_params(CadDone | CadDetected);
+  clear_all_irq();
+
+  send_command(hal, cmds::set_cad);
+  // CAD last a few symbols, radio goes back to standby after.
+  bool const detected =
+      wait_cad_end(rps, 1 << (cad_symbols_parameter(rps.sf) >> 5),
+                   &HalIo::io_check1) &&
+      (get_irq_status() & CadDetected) != 0;
+  PRINT_DEBUG(1, F("CAD freq=%" PRIu32 ", SF=%d, detected=%d"), freq,
+              rps.sf + 6, detected);
+
+  // no interrupt
+  set_dio1_irq_params(0x00);
+  clear_all_irq();
+  set_sleep(true);
+  return detected;
+}
+
+void RadioSx1280::rx_sniff(uint32_t const freq, rps_t const rps,
+                           uint16_t const preamble_syms) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(rps);
+  set_packet_params_lora(rps, MAX_LEN_FRAME, true, preamble_syms);
+  set_sync_word_lora(LORA_MAC_SYNC_WORD);
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  set_dio1_irq_params(RxDone | HeaderError | CrcError | RxTxTimeout);
+  clear_all_irq();
+
+  // Two RX periods and a sleep period must fit in the preamble, to have
+  // one complete RX period in it whatever the phase.
+  uint32_t const tsym = symbol_time_us(rps);
+  uint32_t const rx_us = SNIFF_RX_SYMBOLS * tsym + SNIFF_WAKEUP_US;
+  uint32_t const preamble_us = preamble_syms * tsym;
+  uint32_t const sleep_us =
+      preamble_us > 2 * rx_us ? preamble_us - 2 * rx_us : 0;
+
+  PRINT_DEBUG(1, F("RX SNIFF, freq=%" PRIu32 ", SF=%d, rx=%" PRIu32
+                   " us, sleep=%" PRIu32 " us"),
+              freq, rps.sf + 6, rx_us, sleep_us);
+  hal.clear_edge();
+  set_rx_duty_cycle(rx_us, sleep_us);
+}
+
+void RadioSx1280::tx_raw(uint32_t const freq, RawLoraConfig const &config,
+                         int8_t const txpow, uint8_t const *const framePtr,
+                         uint8_t const frameLength) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(config.rps);
+  set_packet_params_lora(config.rps, frameLength, config.invert_iq,
+                         config.preamble, config.implicit_length != 0);
+  set_sync_word_lora(config.sync_word);
+  set_tx_power(txpow);
+  // enable antenna switch for TX
+  hal.pin_switch_antenna_tx(true);
+
+  write_frame(framePtr, frameLength);
+  clear_all_irq();
+  set_dio1_irq_params(TxDone | RxTxTimeout);
+
+  hal.clear_edge();
+  set_tx();
+  PRINT_DEBUG(1, F("TXMODE RAW, freq=%" PRIu32 ", len=%d, SF=%d"), freq,
+              frameLength, config.rps.sf + 6);
+}
+
+void RadioSx1280::rx_raw(uint32_t const freq, RawLoraConfig const &config) {
+  init_config();
+  set_rf_frequency(freq);
+  set_modulation_params_lora(config.rps);
+  uint8_t const length = config.implicit_length != 0 ? config.implicit_length
+                                                     : MAX_LEN_RAW_FRAME;
+  set_packet_params_lora(config.rps, length, config.invert_iq,
+                         config.preamble, config.implicit_length != 0);
+  set_sync_word_lora(config.sync_word);
+  // enable antenna switch for RX
+  hal.pin_switch_antenna_tx(false);
+
+  set_dio1_irq_params(RxDone | HeaderError | CrcError);
+  clear_all_irq();
+
+  hal.clear_edge();
+  set_rx_continious();
+  PRINT_DEBUG(1, F("RXMODE RAW, freq=%" PRIu32 ", SF=%d"), freq,
+              config.rps.sf + 6);
+}
+
+uint8_t RadioSx1280::read_raw(uint8_t *const framePtr) {
+  uint16_t const flags = get_irq_status();
+
+  uint8_t length = 0;
+  if (flags & HeaderError) {
+    rx_stats.header_error++;
+  } else if (flags & CrcError) {
+    rx_stats.crc_error++;
+  } else if (flags & RxDone) {
+    rx_stats.received++;
+    length = read_frame(framePtr, MAX_LEN_RAW_FRAME);
+    read_packet_status();
+  }
+  // stay in RX, next frame will raise DIO1 again.
+  clear_all_irq();
+  return length;
+}
+
+/**
+ * Check the IO pin.
+ * Return true if the radio has finish it's operation
+ */
+bool RadioSx1280::io_check() const { return hal.io_check1(); }
+
+RadioSx1280::RadioSx1280(lmic_pinmap const &pins) : Radio(pins) {
+  forget_config();
+}
+
+void RadioSx1280::set_sleep(bool const warm_start) {
+  if (warm_start && configured) {
+    PRINT_DEBUG(1, F("Set Radio to sleep (warm start)"));
+    send_command(hal, cmds::set_sleep_warm_start);
+  } else {
+    PRINT_DEBUG(1, F("Set Radio to sleep"));
+    send_command(hal, cmds::set_sleep_cold_start);
+    forget_config();
+  }
+}
+
+void RadioSx1280::forget_config() {
+  configured = false;
+  std::fill_n(current_rf_frequency, sizeof(current_rf_frequency), 0xFF);
+  std::fill_n(current_modulation_params, sizeof(current_modulation_params),
+              0xFF);
+  std::fill_n(current_packet_params, sizeof(current_packet_params), 0xFF);
+  std::fill_n(current_tx_params, sizeof(current_tx_params), 0xFF);
+  std::fill_n(current_irq_params, sizeof(current_irq_params), 0xFF);
+  std::fill_n(current_sync_word, sizeof(current_sync_word), 0xFF);
+}
+
+void RadioSx1280::set_standby(bool use_xosc) const {
+  // RC mode
+  uint8_t const param1 = use_xosc ? 0x01 : 0x00;
+  send_command(hal, Sx1280Command<1>{RadioCommand::SetStandby, {param1}});
+}
+
+void RadioSx1280::set_modulation_params_lora(rps_t const rps) {
+  // Only 812kHz bandwidth. Low data rate optimization is automatic.
+  Sx1280Command<3> const cmd{RadioCommand::SetModulationParams,
+                             {
+                                 sf_to_parameter(rps.sf),
+                                 // BW 812kHz
+                                 0x18,
+                                 cr_to_parameter(rps.getCr()),
+                             }};
+  if (!command_changed(cmd, current_modulation_params))
+    return;
+
+  send_command(hal, cmd);
+  uint8_t const sf_config = rps.sf <= SF8 ? 0x37 : 0x32;
+  write_register(hal,
+                 Sx1280Register<1>{REG_SF_ADDITIONAL_CONFIG, {sf_config}});
+  write_register(hal, Sx1280Register<1>{REG_FREQ_ERROR_CORRECTION, {0x01}});
+}
+
+void RadioSx1280::set_rf_frequency(uint32_t const freq) {
+  uint32_t const steps = rf_frequency_steps(corrected_frequency(freq));
+  Sx1280Command<3> const cmd{RadioCommand::SetRfFrequency,
+                             {static_cast<uint8_t>(steps >> 16),
+                              static_cast<uint8_t>(steps >> 8),
+                              static_cast<uint8_t>(steps)}};
+  if (command_changed(cmd, current_rf_frequency))
+    send_command(hal, cmd);
+}
+
+void RadioSx1280::set_packet_params_lora(rps_t const rps,
+                                         uint8_t const frameLength,
+                                         bool const inv,
+                                         uint16_t const preamble,
+                                         bool const implicit_header) {
+  Sx1280Command<7> const cmd{RadioCommand::SetPacketParams,
+                             {
+                                 preamble_parameter(preamble),
+                                 // explicit or implicit header
+                                 static_cast<uint8_t>(
+                                     implicit_header ? 0x80 : 0x00),
+                                 // length
+                                 frameLength,
+                                 // crc
+                                 static_cast<uint8_t>(rps.nocrc ? 0x00 : 0x20),
+                                 // inv for rx (0x40 is standard IQ)
+                                 static_cast<uint8_t>(inv ? 0x00 : 0x40),
+                                 0x00,
+                                 0x00,
+                             }};
+
+  if (command_changed(cmd, current_packet_params))
+    send_command(hal, cmd);
+}
+
+void RadioSx1280::set_sync_word_lora(uint8_t const sync_word) {
+  // each nibble n is written (n << 4) | 0x4 : 0x21 => 0x24, 0x14
+  uint8_t const value[2] = {static_cast<uint8_t>((sync_word & 0xF0) | 0x04),
+                            static_cast<uint8_t>((sync_word << 4) | 0x04)};
+  if (std::equal(value, value + sizeof(value), current_sync_word))
+    return;
+  std::copy(value, value + sizeof(value), current_sync_word);
+  write_register(hal, Sx1280Register<2>{REG_LORA_SYNC_WORD,
+                                        {value[0], value[1]}});
+}
+
+void RadioSx1280::init_config() {
+  // Wakeup
+  set_standby(false);
+  if (configured) {
+    // configuration retained in warm start sleep
+    return;
+  }
+
+  PRINT_DEBUG(1, F("Init Configure"));
+  send_command(hal, cmds::set_regulator_mode_dcdc);
+  send_command(hal, cmds::set_packet_type_lora);
+  send_command(hal, cmds::set_buffer_base_address);
+
+  configured = true;
+}
+
+void RadioSx1280::set_tx_power(int8_t const txpow) {
+  // -18 ... +13 dBm
+  int8_t const min_limit = -18;
+  int8_t const max_limit = 13;
+  int8_t const pw = clamp(txpow, min_limit, max_limit);
+
+  // ramp up 20us
+  Sx1280Command<2> const tx_params{
+      RadioCommand::SetTxParams, {static_cast<uint8_t>(pw + 18), 0xE0}};
+  if (command_changed(tx_params, current_tx_params))
+    send_command(hal, tx_params);
+}
+
+void RadioSx1280::write_frame(uint8_t const *framePtr,
+                              uint8_t frameLength) const {
+  hal.beginspi();
+  wait_ready(hal);
+  // Write buffer
+  hal.spi(RadioCommand::WriteBuffer);
+  // offset
+  hal.spi(0x00);
+  hal.spi_write(framePtr, frameLength);
+  hal.endspi();
+}
+
+uint8_t RadioSx1280::read_frame(uint8_t *framePtr,
+                                uint8_t const max_length) const {
+  // read frame status
+  Sx1280Command<2> frame_status = {RadioCommand::GetRxBufferStatus,
+                                   {0x00, 0x00}};
+  read_command(hal, frame_status);
+
+  uint8_t const len = std::min(frame_status.parameter[0], max_length);
+  uint8_t const offset = frame_status.parameter[1];
+
+  hal.beginspi();
+  wait_ready(hal);
+  hal.spi(RadioCommand::ReadBuffer);
+  hal.spi(offset);
+  hal.spi(0x00);
+  hal.spi_read(framePtr, len);
+  hal.endspi();
+  return len;
+}
+
+uint8_t RadioSx1280::get_status() const {
+  // status is returned while the command is sent
+  hal.beginspi();
+  uint8_t const status = hal.spi(RadioCommand::GetStatus);
+  hal.endspi();
+  return status;
+}
+
+uint16_t RadioSx1280::get_irq_status() const {
+  Sx1280Command<2> cmd = {RadioCommand::GetIrqStatus, {}};
+  read_command(hal, cmd);
+  return rmsbf2(cmd.parameter);
+}
+
+void RadioSx1280::clear_all_irq() const {
+  send_command(hal, cmds::clear_all_irq);
+}
+
+void RadioSx1280::set_dio1_irq_params(uint16_t const mask) {
+  auto const maskH = static_cast<uint8_t>(mask >> 8);
+  auto const maskL = static_cast<uint8_t>(mask & 0xFF);
+
+  Sx1280Command<8> const cmd{RadioCommand::SetDioIrqParams,
+                             {maskH, maskL,
+                              // DIO1
+                              maskH, maskL,
+                              // DIO2
+                              0x00, 0x00,
+                              // DIO 3
+                              0x00, 0x00}};
+  if (command_changed(cmd, current_irq_params))
+    send_command(hal, cmd);
+}
+
+void RadioSx1280::set_rx(uint32_t const timeout_us) const {
+  uint8_t const base = period_base(timeout_us);
+  uint16_t const count = period_count(base, timeout_us);
+  send_command(hal, Sx1280Command<3>{RadioCommand::SetRx,
+                                     {base, static_cast<uint8_t>(count >> 8),
+                                      static_cast<uint8_t>(count)}});
+}
+
+void RadioSx1280::set_rx_continious() const {
+  send_command(hal, cmds::set_rx_continious);
+}
+
+void RadioSx1280::set_rx_duty_cycle(uint32_t const rx_us,
+                                    uint32_t const sleep_us) const {
+  // same step for the two periods
+  uint8_t const base = period_base(std::max(rx_us, sleep_us));
+  uint16_t const rx_period = period_count(base, rx_us);
+  uint16_t const sleep_period = period_count(base, sleep_us);
+  Sx1280Command<5> const cmd{RadioCommand::SetRxDutyCycle,
+                             {
+                                 base,
+                                 static_cast<uint8_t>(rx_period >> 8),
+                                 static_cast<uint8_t>(rx_period),
+                                 static_cast<uint8_t>(sleep_period >> 8),
+                                 static_cast<uint8_t>(sleep_period),
+                             }};
+  send_command(hal, cmd);
+}
+
+void RadioSx1280::read_packet_status() {
+  Sx1280Command<5> cmd{RadioCommand::GetPacketStatus, {}};
+  read_command(hal, cmd);
+  // RssiSync, SnrPkt
+  // RSSI [dBm] = -RssiSync / 2
+  int16_t const rssi = -static_cast<int16_t>(cmd.parameter[0]) / 2;
+  // SNR [dB] * 4
+  auto const snr = static_cast<int8_t>(cmd.parameter[1]);
+  PRINT_DEBUG(2, F("Packet RSSI %i dBm, SNR*4 %i"), rssi, snr);
+  store_packet_quality(rssi, snr);
+}
+
+uint8_t RadioSx1280::get_rssi_inst() const {
+  Sx1280Command<1> cmd{RadioCommand::GetRssiInst, {}};
+  read_command(hal, cmd);
+  return cmd.parameter[0];
+}
+
+void RadioSx1280::set_tx() const { send_command(hal, cmds::set_tx_10s); }
+
+void RadioSx1280::set_fs() const { send_command(hal, cmds::set_fs); }
@@ -0,0 +1,90 @@
+/*******************************************************************************
+
+ *******************************************************************************/
+
+#ifndef _radio_sx1280_h_
+#define _radio_sx1280_h_
+
+#include "lorabase.h"
+#include "osticks.h"
+#include "radio.h"
+#include <stdint.h>
+
+/**
+ * SX1280 2.4GHz LoRa radio (LoRa 812kHz only, SF7 to SF12).
+ * Busy on DIO0, IRQ on DIO1.
+ */
+class RadioSx1280 final : public Radio {
+private:
+  // Configuration applied to the chip, retained in warm start sleep.
+  // Used to skip command when value do not change.
+  bool configured = false;
+  uint8_t current_rf_frequency[3];
+  uint8_t current_modulation_params[3];
+  uint8_t current_packet_params[7];
+  uint8_t current_tx_params[2];
+  uint8_t current_irq_params[8];
+  uint8_t current_sync_word[2];
+
+  // chip has no packet counters, counted in handle_end_rx().
+  RadioStats rx_stats{};
+
+public:
+  explicit RadioSx1280(lmic_pinmap const &pins);
+  OsDeltaTime init_step() RADIO_FINAL;
+  void rst() RADIO_FINAL;
+  void prepare_tx(uint32_t freq, rps_t rps, int8_t txpow,
+                  uint8_t const *framePtr, uint8_t frameLength) RADIO_FINAL;
+  void start_tx() RADIO_FINAL;
+  void rx(uint32_t freq, rps_t rps, uint8_t rxsyms, OsTime rxtime) RADIO_FINAL;
+
+  bool channel_activity(uint32_t freq, rps_t rps) RADIO_FINAL;
+  void rx_sniff(uint32_t freq, rps_t rps, uint16_t preamble_syms) RADIO_FINAL;
+  void tx_raw(uint32_t freq, RawLoraConfig const &config, int8_t txpow,
+              uint8_t const *framePtr, uint8_t frameLength) RADIO_FINAL;
+  void rx_raw(uint32_t freq, RawLoraConfig const &config) RADIO_FINAL;
+  uint8_t read_raw(uint8_t *framePtr) RADIO_FINAL;
+  void init_random(uint8_t randbuf[16]) RADIO_FINAL;
+  uint8_t handle_end_rx(uint8_t *framePtr) RADIO_FINAL;
+  void handle_end_tx(OsDeltaTime idle) RADIO_FINAL;
+  bool io_check() const RADIO_FINAL;
+
+  int16_t rssi() const RADIO_FINAL;
+  RadioStats stats() const RADIO_FINAL;
+  OsDeltaTime rx_rampup() const RADIO_FINAL;
+  OsDeltaTime tx_rampup() const RADIO_FINAL;
+  OsDeltaTime calibration_rampup(OsTime time) const RADIO_FINAL;
+  void start_calibration(OsTime time) RADIO_FINAL;
+
+private:
+  void set_sleep(bool warm_start);
+  void set_standby(bool use_xosc) const;
+  void set_modulation_params_lora(rps_t rps);
+  void set_rf_frequency(uint32_t freq);
+  void set_packet_params_lora(rps_t rps, uint8_t frameLength, bool inv,
+                              uint16_t preamble = 8,
+                              bool implicit_header = false);
+  void set_sync_word_lora(uint8_t sync_word);
+  void set_tx_power(int8_t txpow);
+
+  void init_config();
+  void forget_config();
+
+  void write_frame(uint8_t const *framePtr, uint8_t frameLength) const;
+  uint8_t read_frame(uint8_t *framePtr, uint8_t max_length) const;
+  uint8_t get_status() const;
+  uint16_t get_irq_status() const;
+
+  void clear_all_irq() const;
+  void set_dio1_irq_params(uint16_t mask);
+  // timeout in us (0 = single RX without timeout)
+  void set_rx(uint32_t timeout_us) const;
+  void set_rx_continious() const;
+  void set_rx_duty_cycle(uint32_t rx_us, uint32_t sleep_us) const;
+  void set_tx() const;
+  void set_fs() const;
+  uint8_t get_rssi_inst() const;
+  void read_packet_status();
+};
+
+#endif
@@ -0,0 +1,177 @@
+/*******************************************************************************
+
+ *******************************************************************************/
+
+#ifndef _radio_sx12xx_cmd_h_
+#define _radio_sx12xx_cmd_h_
+
+#include "../hal/hal_io.h"
+#include "../hal/print_debug.h"
+#include "lmic_table.h"
+
+#include <algorithm>
+#include <stdint.h>
+
+/**
+ * SPI command interface shared by SX126x and SX128x: an opcode followed by
+ * its parameters, busy on DIO0.
+ * Opcode is the chip enum of commands, it must define ReadRegister and
+ * WriteRegister.
+ */
+namespace sx12xx {
+
+/**
+ * Wait for busy pin to go low.
+ * Commands are only posted: the wait is done before the next one, so the
+ * MCU continue its work while the radio execute long commands
+ * (calibration, wake up), and sleep if it needs the radio earlier.
+ */
+inline void wait_ready(HalIo const &hal) { hal.wait_io0_low(); }
+
+template <class Opcode, int parameter_length> struct Command {
+  Opcode const command;
+  uint8_t parameter[parameter_length];
+
+  uint8_t *begin() { return parameter; }
+  uint8_t *end() { return parameter + parameter_length; }
+
+  constexpr uint8_t const *begin() const { return parameter; }
+  constexpr uint8_t const *end() const { return parameter + parameter_length; }
+};
+
+template <class Opcode> struct Command<Opcode, 0> { Opcode const command; };
+
+// Command stored in program memory (PROGMEM).
+template <class Opcode, int length> struct Command_P {
+  Command<Opcode, length> item;
+  constexpr Command_P(Command<Opcode, length> const &it) : item(it) {}
+};
+
+template <class Opcode, int data_length> struct Register {
+  uint16_t const address;
+  uint8_t data[data_length];
+
+  uint8_t *begin() { return data; }
+  uint8_t *end() { return data + data_length; }
+
+  uint8_t const *begin() const { return data; }
+  uint8_t const *end() const { return data + data_length; }
+};
+
+inline void send_command(HalIo const &hal, uint8_t const cmd,
+                         uint8_t const *begin_parameter,
+                         uint8_t const *end_parameter) {
+  PRINT_DEBUG(2, F("Cmd> %x"), cmd);
+  hal.beginspi();
+  wait_ready(hal);
+  hal.spi(cmd);
+  hal.spi_write(begin_parameter, end_parameter - begin_parameter);
+  hal.endspi();
+}
+
+template <class Opcode, int parameter_length>
+void send_command(HalIo const &hal,
+                  Command<Opcode, parameter_length> const &cmd) {
+  send_command(hal, cmd.command, cmd.begin(), cmd.end());
+}
+
+template <class Opcode>
+void send_command(HalIo const &hal, Command<Opcode, 0> const &cmd) {
+  PRINT_DEBUG(2, F("Cmd> %x"), cmd.command);
+  hal.beginspi();
+  wait_ready(hal);
+  hal.spi(cmd.command);
+  hal.endspi();
+}
+
+template <class Opcode, int length>
+void send_command(HalIo const &hal, Command_P<Opcode, length> const &cmd_P) {
+  Command<Opcode, length> cmd{static_cast<Opcode>(0), {}};
+  memcpy_P(static_cast<void *>(&cmd), &cmd_P.item, sizeof(cmd));
+  send_command(hal, cmd);
+}
+
+template <class Opcode>
+void send_command(HalIo const &hal, Command_P<Opcode, 0> const &cmd_P) {
+  Command<Opcode, 0> cmd{static_cast<Opcode>(0)};
+  memcpy_P(static_cast<void *>(&cmd), &cmd_P.item, sizeof(cmd));
+  send_command(hal, cmd);
+}
+
+inline void read_command(HalIo const &hal, uint8_t const cmd,
+                         uint8_t *begin_parameter, uint8_t *end_parameter) {
+  PRINT_DEBUG(2, F("Cmd< %x"), cmd);
+
+  hal.beginspi();
+  wait_ready(hal);
+  hal.spi(cmd);
+  // status
+  hal.spi(0x00);
+  hal.spi_read(begin_parameter, end_parameter - begin_parameter);
+  hal.endspi();
+}
+
+template <class Opcode, int parameter_length>
+void read_command(HalIo const &hal, Command<Opcode, parameter_length> &cmd) {
+  read_command(hal, cmd.command, cmd.begin(), cmd.end());
+}
+
+/**
+ * Compare command parameters with the value applied to the chip.
+ * Return true and store them if they change.
+ */
+template <class Opcode, int parameter_length>
+bool command_changed(Command<Opcode, parameter_length> const &cmd,
+                     uint8_t (&current)[parameter_length]) {
+  if (std::equal(cmd.begin(), cmd.end(), current)) {
+    PRINT_DEBUG(2, F("Cmd= %x"), cmd.command);
+    return false;
+  }
+  std::copy(cmd.begin(), cmd.end(), current);
+  return true;
+}
+
+template <class Opcode, int data_length>
+void read_register(HalIo const &hal, Register<Opcode, data_length> &reg) {
+  PRINT_DEBUG(2, F("Reg< %x"), reg.address);
+
+  hal.beginspi();
+  wait_ready(hal);
+  hal.spi(Opcode::ReadRegister);
+  // send adress
+  hal.spi(static_cast<uint8_t>(reg.address >> 8));
+  hal.spi(static_cast<uint8_t>(reg.address & 0xff));
+  // send initial NOP
+  hal.spi(0x00);
+
+  // read data
+  hal.spi_read(reg.begin(), data_length);
+
+  hal.endspi();
+}
+
+template <class Opcode>
+void write_register(HalIo const &hal, uint16_t const address,
+                    uint8_t const *const data, uint8_t const length) {
+  PRINT_DEBUG(2, F("Reg> %x"), address);
+
+  hal.beginspi();
+  wait_ready(hal);
+  hal.spi(Opcode::WriteRegister);
+  // send adress
+  hal.spi(static_cast<uint8_t>(address >> 8));
+  hal.spi(static_cast<uint8_t>(address & 0xff));
+  // Write data
+  hal.spi_write(data, length);
+  hal.endspi();
+}
+
+template <class Opcode, int data_length>
+void write_register(HalIo const &hal,
+                    Register<Opcode, data_length> const &reg) {
+  write_register<Opcode>(hal, reg.address, reg.begin(), data_length);
+}
+
+} // namespace sx12xx
+
+#endif
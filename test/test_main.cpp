@@ -1,12 +1,26 @@
+#ifdef ARDUINO
 #include <Arduino.h>
+#endif
 #include <unity.h>
 
 #include "test_aes.h"
+#include "test_sx127x.h"
+#include "test_sx1280.h"
 
-void setup() {
+int run_tests() {
      UNITY_BEGIN();
      test_aes::run();
-     UNITY_END();
+#ifndef ARDUINO
+     // radio models of the host HAL
+     test_sx127x::run();
+     test_sx1280::run();
+#endif
+     return UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup() {
+     run_tests();
 }
 
 void loop() {
@@ -14,4 +28,9 @@ void loop() {
         set_sleep_mode(SLEEP_MODE_PWR_DOWN);
         sleep_mode();
     #endif
-}
\ No newline at end of file
+}
+#else
+int main() {
+    return run_tests();
+}
+#endif
@@ -0,0 +1,158 @@
+#ifndef ARDUINO
+#include "test_sx127x.h"
+
+#include "hal/hal_native.h"
+#include "lmic/radio_sx1276.h"
+#include <unity.h>
+
+namespace
+{
+// SX127x registers behind SPI, no modem: IRQ lines and flags stay low.
+class Sx127xModel : public HalNativeRadio
+{
+public:
+    uint8_t regs[0x80] = {};
+    // values read in turn from RegRssiWideband (register value if empty)
+    uint8_t const *wideband = nullptr;
+    uint8_t wideband_length = 0;
+
+    Sx127xModel() { regs[RegVersion] = 0x12; }
+
+    void begin_spi() override { first = true; }
+
+    uint8_t spi(uint8_t const out) override
+    {
+        if (first)
+        {
+            first = false;
+            write = out & 0x80;
+            address = out & 0x7F;
+            return 0;
+        }
+        uint8_t val = regs[address];
+        if (address == RegRssiWideband && wideband_length)
+        {
+            val = wideband[wideband_read++ % wideband_length];
+        }
+        if (write && address == RegIrqFlags)
+        {
+            // flags are cleared by writing 1
+            regs[address] &= ~out;
+        }
+        else if (write)
+        {
+            regs[address] = out;
+        }
+        // FIFO address is not incremented
+        if (address != RegFifo)
+        {
+            address = (address + 1) & 0x7F;
+        }
+        return val;
+    }
+
+    bool dio(uint8_t) const override { return false; }
+
+private:
+    static const uint8_t RegFifo = 0x00;
+    static const uint8_t RegIrqFlags = 0x12;
+    static const uint8_t RegRssiWideband = 0x2C;
+    static const uint8_t RegVersion = 0x42;
+    uint16_t wideband_read = 0;
+    bool first = true;
+    bool write = false;
+    uint8_t address = 0;
+};
+
+constexpr lmic_pinmap pins = {10, nullptr, LMIC_UNUSED_PIN, {2, 3}, 0};
+constexpr uint32_t frequency = 868100000;
+rps_t const rps{SF9, BandWidth::BW125, CodingRate::CR_4_5, false};
+uint8_t const frame[] = {0x40, 0x01, 0x02, 0x03, 0x04};
+
+} // namespace
+
+namespace test_sx127x
+{
+
+void run()
+{
+    RUN_TEST(test_header_missing_ends_rx);
+    RUN_TEST(test_rst_ends_header_wait);
+    RUN_TEST(test_random_unbiased_bits);
+    RUN_TEST(test_random_stuck_noise);
+}
+
+// no ValidHeader flag after the preamble time: RX is reported done.
+void test_header_missing_ends_rx()
+{
+    Sx127xModel model;
+    hal_native_attach(pins.nss, &model);
+    RadioSx1276 radio{pins};
+    radio.init();
+
+    radio.rx(frequency, rps, 8, os_getTime());
+    TEST_ASSERT_FALSE(radio.io_check());
+    hal_wait(OsDeltaTime::from_sec(1));
+    TEST_ASSERT_TRUE(radio.io_check());
+
+    hal_native_attach(pins.nss, nullptr);
+}
+
+// rst() during a RX window, the next TX must not be reported done by the
+// header check of the RX.
+void test_rst_ends_header_wait()
+{
+    Sx127xModel model;
+    hal_native_attach(pins.nss, &model);
+    RadioSx1276 radio{pins};
+    radio.init();
+
+    radio.rx(frequency, rps, 8, os_getTime());
+    radio.rst();
+    hal_wait(OsDeltaTime::from_sec(1));
+    radio.prepare_tx(frequency, rps, 14, frame, sizeof(frame));
+    radio.start_tx();
+    TEST_ASSERT_FALSE(radio.io_check());
+
+    hal_native_attach(pins.nss, nullptr);
+}
+
+// equal low bits are dropped, a 10 pair gives 1 and a 01 pair gives 0.
+void test_random_unbiased_bits()
+{
+    uint8_t const noise[] = {0x13, 0x35, 0x57, 0x7A, 0x9C, 0xBE, 0xD0, 0xF3};
+    Sx127xModel model;
+    model.wideband = noise;
+    model.wideband_length = sizeof(noise);
+    hal_native_attach(pins.nss, &model);
+    RadioSx1276 radio{pins};
+    radio.init();
+
+    uint8_t randbuf[16] = {};
+    radio.init_random(randbuf);
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        TEST_ASSERT_EQUAL(0xAA, randbuf[i]);
+    }
+
+    hal_native_attach(pins.nss, nullptr);
+}
+
+// noise register never changes: seed collection still ends.
+void test_random_stuck_noise()
+{
+    Sx127xModel model;
+    hal_native_attach(pins.nss, &model);
+    RadioSx1276 radio{pins};
+    radio.init();
+
+    uint8_t randbuf[16] = {};
+    radio.init_random(randbuf);
+    TEST_ASSERT_EQUAL(0, randbuf[0]);
+
+    hal_native_attach(pins.nss, nullptr);
+}
+
+} // namespace test_sx127x
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef __test_sx127x_h__
+#define __test_sx127x_h__
+
+
+namespace test_sx127x {
+    void run();
+    void test_header_missing_ends_rx();
+    void test_rst_ends_header_wait();
+    void test_random_unbiased_bits();
+    void test_random_stuck_noise();
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef ARDUINO
+#include "test_sx1280.h"
+
+#include "hal/hal_native.h"
+#include "lmic/radio_sx1280.h"
+#include <unity.h>
+
+namespace
+{
+// SX1280 opcodes (datasheet table 11-1)
+constexpr uint8_t WriteRegister = 0x18;
+constexpr uint8_t WriteBuffer = 0x1A;
+constexpr uint8_t SetTx = 0x83;
+constexpr uint8_t SetRfFrequency = 0x86;
+constexpr uint8_t SetModulationParams = 0x8B;
+constexpr uint8_t SetTxParams = 0x8E;
+constexpr uint8_t ClrIrqStatus = 0x97;
+constexpr uint16_t REG_LORA_SYNC_WORD = 0x0944;
+
+// Record the SPI commands sent to the chip (first bytes of each transfer),
+// never busy, reads return 0.
+class CommandRecorder : public HalNativeRadio
+{
+public:
+    static const uint8_t max_commands = 32;
+    static const uint8_t max_bytes = 8;
+
+    struct Command
+    {
+        uint8_t bytes[max_bytes];
+        uint8_t length;
+    };
+
+    Command commands[max_commands];
+    uint8_t count = 0;
+
+    void begin_spi() override
+    {
+        if (count < max_commands)
+        {
+            commands[count].length = 0;
+        }
+    }
+
+    uint8_t spi(uint8_t const out) override
+    {
+        if (count < max_commands)
+        {
+            Command &cmd = commands[count];
+            if (cmd.length < max_bytes)
+            {
+                cmd.bytes[cmd.length] = out;
+            }
+            cmd.length++;
+        }
+        return 0;
+    }
+
+    void end_spi() override { count++; }
+
+    bool dio(uint8_t) const override { return false; }
+
+    void clear() { count = 0; }
+
+    // index of the first command with this opcode, count if not sent.
+    uint8_t find(uint8_t const opcode) const
+    {
+        for (uint8_t i = 0; i < count && i < max_commands; i++)
+        {
+            if (commands[i].bytes[0] == opcode)
+            {
+                return i;
+            }
+        }
+        return count;
+    }
+
+    // index of the first write of this register, count if not written.
+    uint8_t find_register(uint16_t const address) const
+    {
+        for (uint8_t i = 0; i < count && i < max_commands; i++)
+        {
+            Command const &cmd = commands[i];
+            if (cmd.bytes[0] == WriteRegister && cmd.length > 3 &&
+                cmd.bytes[1] == (address >> 8) &&
+                cmd.bytes[2] == (address & 0xFF))
+            {
+                return i;
+            }
+        }
+        return count;
+    }
+};
+
+constexpr lmic_pinmap pins = {10, nullptr, LMIC_UNUSED_PIN, {2, 3}, 0};
+constexpr uint32_t frequency = 2403000000;
+rps_t const rps{SF12, BandWidth::BW800, CodingRate::CR_4_5, false};
+uint8_t const frame[] = {0x40, 0x01, 0x02, 0x03, 0x04};
+
+} // namespace
+
+namespace test_sx1280
+{
+
+void run()
+{
+    RUN_TEST(test_tx_commands);
+    RUN_TEST(test_unchanged_config_not_sent);
+    RUN_TEST(test_cad_timeout);
+}
+
+// commands use the SX1280 opcodes, not the SX1262 ones.
+void test_tx_commands()
+{
+    CommandRecorder recorder;
+    hal_native_attach(pins.nss, &recorder);
+    RadioSx1280 radio{pins};
+    radio.init();
+    recorder.clear();
+
+    radio.tx(frequency, rps, 10, frame, sizeof(frame));
+
+    uint8_t const freq = recorder.find(SetRfFrequency);
+    TEST_ASSERT_TRUE(freq < recorder.count);
+    TEST_ASSERT_EQUAL(4, recorder.commands[freq].length);
+
+    // LoRaWAN sync word 0x21 at 0x0944
+    uint8_t const sync_word = recorder.find_register(REG_LORA_SYNC_WORD);
+    TEST_ASSERT_TRUE(sync_word < recorder.count);
+    uint8_t const sync_word_bytes[] = {WriteRegister, 0x09, 0x44, 0x24, 0x14};
+    TEST_ASSERT_EQUAL_MEMORY(sync_word_bytes,
+                                  recorder.commands[sync_word].bytes,
+                                  sizeof(sync_word_bytes));
+
+    uint8_t const buffer = recorder.find(WriteBuffer);
+    TEST_ASSERT_TRUE(buffer < recorder.count);
+    TEST_ASSERT_EQUAL(2 + sizeof(frame), recorder.commands[buffer].length);
+    TEST_ASSERT_EQUAL_MEMORY(frame, recorder.commands[buffer].bytes + 2,
+                                  sizeof(frame));
+
+    uint8_t const clear = recorder.find(ClrIrqStatus);
+    TEST_ASSERT_TRUE(clear < recorder.count);
+    TEST_ASSERT_EQUAL(3, recorder.commands[clear].length);
+
+    // TX started, then the status is read
+    TEST_ASSERT_EQUAL(SetTx,
+                      recorder.commands[recorder.count - 2].bytes[0]);
+
+    hal_native_attach(pins.nss, nullptr);
+}
+
+// the configuration is retained in warm sleep, same TX again only send the
+// frame.
+void test_unchanged_config_not_sent()
+{
+    CommandRecorder recorder;
+    hal_native_attach(pins.nss, &recorder);
+    RadioSx1280 radio{pins};
+    radio.init();
+
+    radio.tx(frequency, rps, 10, frame, sizeof(frame));
+    radio.handle_end_tx(OsDeltaTime(0));
+    recorder.clear();
+    radio.tx(frequency, rps, 10, frame, sizeof(frame));
+
+    TEST_ASSERT_EQUAL(recorder.count, recorder.find(SetRfFrequency));
+    TEST_ASSERT_EQUAL(recorder.count, recorder.find(SetModulationParams));
+    TEST_ASSERT_EQUAL(recorder.count, recorder.find(SetTxParams));
+    TEST_ASSERT_EQUAL(recorder.count,
+                      recorder.find_register(REG_LORA_SYNC_WORD));
+    TEST_ASSERT_TRUE(recorder.find(WriteBuffer) < recorder.count);
+
+    hal_native_attach(pins.nss, nullptr);
+}
+
+// DIO1 never rises: CAD gives up after its duration, channel is free.
+void test_cad_timeout()
+{
+    CommandRecorder recorder;
+    hal_native_attach(pins.nss, &recorder);
+    RadioSx1280 radio{pins};
+    radio.init();
+
+    OsTime const start = hal_ticks();
+    TEST_ASSERT_FALSE(radio.channel_activity(frequency, rps));
+    TEST_ASSERT_TRUE(hal_ticks() - start < OsDeltaTime::from_ms(50));
+
+    hal_native_attach(pins.nss, nullptr);
+}
+
+} // namespace test_sx1280
+
+#endif
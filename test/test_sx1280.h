@@ -0,0 +1,12 @@
+#ifndef __test_sx1280_h__
+#define __test_sx1280_h__
+
+
+namespace test_sx1280 {
+    void run();
+    void test_tx_commands();
+    void test_unchanged_config_not_sent();
+    void test_cad_timeout();
+}
+
+#endif